@@ -1,41 +1,383 @@
 #include <benchmark/benchmark.h>
 #include <iostream>
-#include "Game.hpp"
-#include "MonteCarlo.hpp"
+#include <vector>
+#include "Arena.hpp"
+#include "BatchRollout.hpp"
+#include "Board.hpp"
+#include "HeuristicEvaluator.hpp"
+#include "Mcts.hpp"
+#include "Solver.hpp"
+#include "ThreadPool.hpp"
 
+constexpr uint64_t BENCHMARK_SEED = 2048;
+constexpr int CORPUS_SIZE = 4096;
+
+// Positions of seeded random games, from the opening to the end, so that the
+// kernels below run on the mix of boards a search actually meets
+static const std::vector<Board>& boardCorpus() {
+    static const std::vector<Board> corpus = [] {
+        std::vector<Board> boards;
+        Rng gen(BENCHMARK_SEED);
+        while (boards.size() < CORPUS_SIZE) {
+            Board board = newBoard(gen);
+            while (!isGameOver(board.grid) && boards.size() < CORPUS_SIZE) {
+                boards.push_back(board);
+                int legal = legalMoves(board.grid);
+                playMove(board, static_cast<Move>(selectBit(legal, randomBelow(gen, __builtin_popcount(legal)))), gen);
+            }
+        }
+        return boards;
+    }();
+    return corpus;
+}
+
+// A board from the first tenth of the corpus, where rollouts are long
+static const Board& openingBoard() {
+    return boardCorpus()[CORPUS_SIZE / 10];
+}
+
+// Layer benchmarks: each times one building block on fixed inputs and seeds
+// and reports items/s, so that a change in a full game can be traced to the
+// layer that caused it
+
+static void BM_MoveGrid(benchmark::State& state) {
+    const std::vector<Board>& corpus = boardCorpus();
+    Move move = static_cast<Move>(state.range(0));
+    for (auto _ : state) {
+        for (const Board& board : corpus) {
+            uint32_t score = 0;
+            benchmark::DoNotOptimize(moveGrid(board.grid, move, score));
+            benchmark::DoNotOptimize(score);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+    state.SetLabel(move == Move::LEFT ? "left" : move == Move::RIGHT ? "right" : move == Move::UP ? "up" : "down");
+}
+
+BENCHMARK(BM_MoveGrid)->DenseRange(0, NUMBER_OF_MOVES - 1);
+
+static void BM_LegalMoves(benchmark::State& state) {
+    const std::vector<Board>& corpus = boardCorpus();
+    for (auto _ : state) {
+        for (const Board& board : corpus) {
+            benchmark::DoNotOptimize(legalMoves(board.grid));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+
+BENCHMARK(BM_LegalMoves);
+
+static void BM_IsGameOver(benchmark::State& state) {
+    const std::vector<Board>& corpus = boardCorpus();
+    for (auto _ : state) {
+        for (const Board& board : corpus) {
+            benchmark::DoNotOptimize(isGameOver(board.grid));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+
+BENCHMARK(BM_IsGameOver);
+
+static void BM_AddRandomTile(benchmark::State& state) {
+    const std::vector<Board>& corpus = boardCorpus();
+    Rng gen(BENCHMARK_SEED);
+    for (auto _ : state) {
+        for (const Board& board : corpus) {
+            Board spawned = board;
+            benchmark::DoNotOptimize(addRandomTile(spawned, gen));
+            benchmark::DoNotOptimize(spawned.grid);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+
+BENCHMARK(BM_AddRandomTile);
+
+static void BM_RandomBelow(benchmark::State& state) {
+    Rng gen(BENCHMARK_SEED);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(randomBelow(gen, NUMBER_OF_MOVES));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RandomBelow);
+
+// One uniform rollout to DEPTH per iteration, from the same position each time
+static void BM_Simulate(benchmark::State& state) {
+    const Board& board = openingBoard();
+    Rng gen(BENCHMARK_SEED);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simulate(board, gen));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_Simulate);
+
+// The same rollouts through each SIMD kernel, 64 per call
+static void BM_BatchedRollouts(benchmark::State& state) {
+    BatchIsa isa = static_cast<BatchIsa>(state.range(0));
+    if (!batchIsaSupported(isa)) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+
+    constexpr int ROLLOUTS_PER_CALL = 64;
+    const Board& board = openingBoard();
+    Move move = static_cast<Move>(__builtin_ctz(legalMoves(board.grid)));
+    Rng gen(BENCHMARK_SEED);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(runSimulationsBatched(board, move, ROLLOUTS_PER_CALL, gen, isa).total);
+    }
+    state.SetItemsProcessed(state.iterations() * ROLLOUTS_PER_CALL);
+    state.SetLabel(isa == BatchIsa::PORTABLE ? "portable" : isa == BatchIsa::AVX2 ? "avx2" : "avx512");
+}
+
+BENCHMARK(BM_BatchedRollouts)->DenseRange(0, 2);
+
+// One-shot searches, pool creation included, on arguments threads and
+// rollouts per move
+static void BM_PerformMC(benchmark::State& state) {
+    const Board& board = openingBoard();
+    int numThreads = static_cast<int>(state.range(0));
+    int simulations = static_cast<int>(state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(performMC(board, simulations, numThreads, BENCHMARK_SEED));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["rollouts/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * simulations * __builtin_popcount(legalMoves(board.grid)), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_PerformMC)->ArgsProduct({ { 1, 2, 4 }, { 100, 300 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// The same searches on a long-lived solver, the difference with BM_PerformMC
+// being the setup a caller saves by keeping one
+static void BM_SolverSearch(benchmark::State& state) {
+    const Board& board = openingBoard();
+    SolverOptions options;
+    options.numThreads = static_cast<int>(state.range(0));
+    options.numberOfSimulationsPerMove = static_cast<int>(state.range(1));
+    options.seed = BENCHMARK_SEED;
+    options.tableSizeInMegabytes = 0;
+    Solver solver(options);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(solver.search(board).move);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["rollouts/s"] = benchmark::Counter(static_cast<double>(solver.rolloutsPlayed()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_SolverSearch)->ArgsProduct({ { 1, 2, 4 }, { 100, 300 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+constexpr int SEARCH_BATCH_SIZE = 64;
+
+// Corpus positions searched one call at a time or in one batch, on few
+// rollouts, where the per-round synchronization of single searches dominates
+static void BM_SolverSearchBatch(benchmark::State& state) {
+    const std::vector<Board>& corpus = boardCorpus();
+    std::vector<Grid> grids;
+    for (int i = 0; i < SEARCH_BATCH_SIZE; ++i) {
+        grids.push_back(corpus[i * (CORPUS_SIZE / SEARCH_BATCH_SIZE)].grid);
+    }
+
+    SolverOptions options;
+    options.numThreads = static_cast<int>(state.range(0));
+    options.numberOfSimulationsPerMove = 20;
+    options.seed = BENCHMARK_SEED;
+    options.tableSizeInMegabytes = 0;
+    Solver solver(options);
+    bool batched = state.range(1) != 0;
+
+    for (auto _ : state) {
+        if (batched) {
+            benchmark::DoNotOptimize(solver.searchBatch(grids).data());
+            continue;
+        }
+        for (Grid grid : grids) {
+            benchmark::DoNotOptimize(solver.bestMove(grid));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * grids.size());
+    state.SetLabel(batched ? "batch" : "one by one");
+}
+
+BENCHMARK(BM_SolverSearchBatch)->ArgsProduct({ { 1, 2, 4 }, { 0, 1 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_MctsSearch(benchmark::State& state) {
+    const Board& board = openingBoard();
+    MctsOptions options;
+    options.numThreads = static_cast<int>(state.range(0));
+    options.iterations = static_cast<int>(state.range(1));
+    options.seed = BENCHMARK_SEED;
+    options.reuseTree = false;
+    Mcts mcts(options);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mcts.search(board).move);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["playouts/s"] = benchmark::Counter(static_cast<double>(mcts.playoutsPlayed()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_MctsSearch)->ArgsProduct({ { 1, 2, 4 }, { 400, 1200 } })->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Round trip of an empty job from outside the pool to a worker and back,
+// including the two allocations enqueue() makes per call
+static void BM_ThreadPoolEnqueue(benchmark::State& state) {
+    ThreadPool pool(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        pool.enqueue([] { return 1; }).get();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ThreadPoolEnqueue)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// Fork and join of one empty task per worker, the fan-out of a solver round
+static void BM_ThreadPoolParallelFor(benchmark::State& state) {
+    int numThreads = static_cast<int>(state.range(0));
+    ThreadPool pool(static_cast<size_t>(numThreads));
+    std::vector<int> touched(NUMBER_OF_MOVES * numThreads);
+    for (auto _ : state) {
+        pool.parallelFor(0, static_cast<int>(touched.size()), 1, [&](int task) {
+            touched[task]++;
+        });
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ThreadPoolParallelFor)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+// Allocation of search nodes and the reset that releases them between moves
+static void BM_ArenaNodes(benchmark::State& state) {
+    constexpr int NODES_PER_TREE = 10000;
+    Arena arena;
+    for (auto _ : state) {
+        for (int i = 0; i < NODES_PER_TREE; ++i) {
+            benchmark::DoNotOptimize(arena.make<MctsNode>());
+        }
+        arena.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * NODES_PER_TREE);
+    state.counters["high_water_bytes"] = static_cast<double>(arena.highWaterMark());
+}
+
+BENCHMARK(BM_ArenaNodes);
+
+// End-to-end games up to 2048, game i of a run always replays the same seeds
 static int reach2048Count = 0;
 static int numberOfGamesPlayed = 0;
 
 static void BM_2048Game(benchmark::State& state) {
     constexpr int NUMBER_OF_SIMULATIONS_PER_MOVE = 400;
     int NUMBER_OF_THREADS = std::thread::hardware_concurrency();
+
+    SolverOptions options;
+    options.numberOfSimulationsPerMove = NUMBER_OF_SIMULATIONS_PER_MOVE;
+    options.numThreads = NUMBER_OF_THREADS;
+    options.seed = BENCHMARK_SEED;
+    Solver solver(options);
+
     for (auto _ : state) {
-        std::unique_ptr<Game> game = std::make_unique<Game>();
+        Rng gen(deriveSeed(BENCHMARK_SEED, numberOfGamesPlayed));
+        Board board = newBoard(gen);
+        solver.newGame();
+        solver.reseed(deriveSeed(BENCHMARK_SEED, numberOfGamesPlayed));
 
-        while (!game->isGameOver() && !game->reached2048()) {
-            Move bestMove = performMC(*(game.get()), NUMBER_OF_SIMULATIONS_PER_MOVE, NUMBER_OF_THREADS);
-            bool validMove = game->makeMove(bestMove);
+        while (!isGameOver(board.grid) && !reached2048(board.grid)) {
+            Move bestMove = solver.bestMove(board);
+            bool validMove = playMove(board, bestMove, gen);
 
             if (!validMove) {
                 for (int i = 0; i < 3; i++) {
-                    validMove = game->makeMove(static_cast<Move>(i));
+                    validMove = playMove(board, static_cast<Move>(i), gen);
                     if (validMove) {
                         break;
                     } 
                 }
             }
 
-            if (game->reached2048()) {
+            if (reached2048(board.grid)) {
                 reach2048Count++;
             }
         }
         numberOfGamesPlayed++;
-        std::cout << *game << " " << reach2048Count << "/" << numberOfGamesPlayed << std::endl;
     }
 
     state.counters["2048_Reached"] = reach2048Count;
+    state.counters["games"] = numberOfGamesPlayed;
 }
 
 BENCHMARK(BM_2048Game)->Repetitions(50);
 
+// Cost and strength of each rollout policy: every iteration plays a full game
+// with the same seeds on one worker, so that the time per move and the final
+// score can be compared across the variants. The search runs on the pool, the
+// rates are therefore measured in real time.
+static void BM_RolloutPolicy(benchmark::State& state) {
+    static const HeuristicEvaluator heuristic;
+    SolverOptions options;
+    options.numberOfSimulationsPerMove = 100;
+    options.numThreads = 1;
+    options.seed = BENCHMARK_SEED;
+    options.tableSizeInMegabytes = 0;
+
+    RolloutOptions& rollout = options.rollout;
+    switch (state.range(0)) {
+    case 0:
+        state.SetLabel("uniform to DEPTH");
+        break;
+    case 1:
+        state.SetLabel("legal random to DEPTH");
+        rollout.policy = RolloutPolicy::LEGAL_RANDOM;
+        break;
+    case 2:
+        state.SetLabel("legal random, 30 moves + heuristic");
+        rollout.policy = RolloutPolicy::LEGAL_RANDOM;
+        rollout.depth = TRUNCATED_ROLLOUT_DEPTH;
+        rollout.evaluator = &heuristic;
+        break;
+    case 3:
+        state.SetLabel("greedy, 30 moves + heuristic");
+        rollout.policy = RolloutPolicy::GREEDY;
+        rollout.depth = TRUNCATED_ROLLOUT_DEPTH;
+        rollout.evaluator = &heuristic;
+        break;
+    default:
+        state.SetLabel("epsilon-greedy, 30 moves + heuristic");
+        rollout.policy = RolloutPolicy::EPSILON_GREEDY;
+        rollout.depth = TRUNCATED_ROLLOUT_DEPTH;
+        rollout.evaluator = &heuristic;
+        break;
+    }
+
+    Solver solver(options);
+    uint64_t game = 0;
+    double totalScore = 0.0;
+    double totalMoves = 0.0;
+    for (auto _ : state) {
+        Rng gen(deriveSeed(BENCHMARK_SEED, game));
+        solver.newGame();
+        solver.reseed(deriveSeed(BENCHMARK_SEED, game++));
+
+        Board board = newBoard(gen);
+        while (!isGameOver(board.grid)) {
+            playMove(board, solver.bestMove(board), gen);
+            totalMoves += 1.0;
+        }
+        totalScore += board.score;
+    }
+
+    state.counters["score"] = benchmark::Counter(totalScore, benchmark::Counter::kAvgIterations);
+    state.counters["moves/s"] = benchmark::Counter(totalMoves, benchmark::Counter::kIsRate);
+    state.counters["rollouts/s"] = benchmark::Counter(static_cast<double>(solver.rolloutsPlayed()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_RolloutPolicy)->DenseRange(0, 4)->Iterations(3)->UseRealTime()->Unit(benchmark::kMillisecond);
+
 BENCHMARK_MAIN();
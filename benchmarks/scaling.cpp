@@ -0,0 +1,212 @@
+// Strong and weak scaling sweep of the Monte Carlo solver over thread counts
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.hpp"
+#include "Random.hpp"
+#include "Solver.hpp"
+
+enum class ScalingMode { STRONG = 0, WEAK = 1 };
+
+struct ScalingOptions {
+    // Positions searched at every thread count
+    int positions = 64;
+    // Rollouts per move, per thread in weak mode
+    int simulations = NUMBER_OF_SIMULATIONS_PER_MOVE;
+    int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    // Every thread count up to maxThreads instead of the powers of two
+    bool everyCount = false;
+    // Passes over the positions, the fastest is kept
+    int repeat = 3;
+    uint64_t seed = 2048;
+    bool strong = true;
+    bool weak = true;
+    bool pin = false;
+};
+
+// Searches of one thread count over the whole corpus
+struct SweepPoint {
+    int threads = 1;
+    int simulations = 0;
+    double seconds = 0.0;
+    uint64_t rollouts = 0;
+    std::vector<Move> moves;
+
+    double rolloutsPerSecond() const {
+        return seconds > 0.0 ? rollouts / seconds : 0.0;
+    }
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --mode MODE        strong, weak or both (both)\n"
+              << "  --positions N      positions searched per thread count (64)\n"
+              << "  --sims N           rollouts per move, per thread in weak mode (" << NUMBER_OF_SIMULATIONS_PER_MOVE << ")\n"
+              << "  --max-threads N    largest thread count (hardware threads)\n"
+              << "  --counts COUNTS    pow2 for 1, 2, 4... and the largest, all for every count (pow2)\n"
+              << "  --repeat N         passes over the positions, the fastest is kept (3)\n"
+              << "  --seed N           seed of the positions and of the searches (2048)\n"
+              << "  --pin 0|1          bind every worker to its own CPU (0)\n";
+}
+
+static bool parseOptions(int argc, char* argv[], ScalingOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h" || i + 1 == argc) {
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (flag == "--mode") {
+            if (value != "strong" && value != "weak" && value != "both") {
+                std::cerr << "Unknown mode " << value << "\n";
+                return false;
+            }
+            options.strong = value != "weak";
+            options.weak = value != "strong";
+        } else if (flag == "--positions") {
+            options.positions = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--sims") {
+            options.simulations = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--max-threads") {
+            options.maxThreads = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--counts") {
+            if (value != "pow2" && value != "all") {
+                std::cerr << "Unknown thread counts " << value << "\n";
+                return false;
+            }
+            options.everyCount = value == "all";
+        } else if (flag == "--repeat") {
+            options.repeat = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--pin") {
+            options.pin = std::atoi(value.c_str()) != 0;
+        } else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every seventh position of seeded random games, so that the sweep covers
+// openings, middle games and endings alike
+static std::vector<Board> positionCorpus(int positions, uint64_t seed) {
+    constexpr int STRIDE = 7;
+    std::vector<Board> corpus;
+    Rng gen(seed);
+    int ply = 0;
+    while (static_cast<int>(corpus.size()) < positions) {
+        Board board = newBoard(gen);
+        while (!isGameOver(board.grid) && static_cast<int>(corpus.size()) < positions) {
+            if (ply++ % STRIDE == 0) {
+                corpus.push_back(board);
+            }
+            int legal = legalMoves(board.grid);
+            playMove(board, static_cast<Move>(selectBit(legal, randomBelow(gen, __builtin_popcount(legal)))), gen);
+        }
+    }
+    return corpus;
+}
+
+static std::vector<int> threadCounts(const ScalingOptions& options) {
+    std::vector<int> counts;
+    for (int threads = 1; threads < options.maxThreads; threads = options.everyCount ? threads + 1 : threads * 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(options.maxThreads);
+    return counts;
+}
+
+// The solver runs without a table, so that every pass plays the same
+// rollouts, and is reseeded before every pass, so that every pass picks the
+// same moves
+static SweepPoint measure(const std::vector<Board>& corpus, int threads, int simulations, const ScalingOptions& options) {
+    SolverOptions solverOptions;
+    solverOptions.numberOfSimulationsPerMove = simulations;
+    solverOptions.numThreads = threads;
+    solverOptions.seed = options.seed;
+    solverOptions.tableSizeInMegabytes = 0;
+    solverOptions.pinThreads = options.pin;
+    Solver solver(solverOptions);
+
+    // Wakes the workers up before anything is timed
+    solver.search(corpus.front());
+
+    SweepPoint point;
+    point.threads = threads;
+    point.simulations = simulations;
+    point.seconds = std::numeric_limits<double>::infinity();
+    point.moves.resize(corpus.size());
+    for (int pass = 0; pass < options.repeat; ++pass) {
+        solver.reseed(options.seed);
+        uint64_t rolloutsBefore = solver.rolloutsPlayed();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < corpus.size(); ++i) {
+            point.moves[i] = solver.search(corpus[i]).move;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        point.seconds = std::min(point.seconds, seconds);
+        point.rollouts = solver.rolloutsPlayed() - rolloutsBefore;
+    }
+    return point;
+}
+
+// Speedup is the rollout throughput over the single thread's, which is the
+// ratio of the times in strong mode and the scaled speedup in weak mode.
+// Agreement is the fraction of positions where the move matches the single
+// thread's of the same mode, the threads playing different random streams
+static void report(ScalingMode mode, const SweepPoint& point, const SweepPoint& single) {
+    double speedup = single.rolloutsPerSecond() > 0.0 ? point.rolloutsPerSecond() / single.rolloutsPerSecond() : 0.0;
+    int agreeing = 0;
+    for (size_t i = 0; i < point.moves.size(); ++i) {
+        agreeing += point.moves[i] == single.moves[i] ? 1 : 0;
+    }
+
+    std::printf("%s,%d,%d,%.4f,%.0f,%.3f,%.3f,%.3f\n", mode == ScalingMode::STRONG ? "strong" : "weak", point.threads,
+        point.simulations, point.seconds, point.rolloutsPerSecond(), speedup, speedup / point.threads,
+        static_cast<double>(agreeing) / point.moves.size());
+    std::fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    ScalingOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Board> corpus = positionCorpus(options.positions, options.seed);
+    std::vector<int> counts = threadCounts(options);
+    std::fprintf(stderr, "%zu positions, %d hardware threads, workers %s\n", corpus.size(),
+        static_cast<int>(std::thread::hardware_concurrency()), options.pin ? "pinned" : "unpinned");
+
+    std::printf("mode,threads,rollouts_per_move,seconds,rollouts_per_second,speedup,efficiency,agreement\n");
+    for (ScalingMode mode : { ScalingMode::STRONG, ScalingMode::WEAK }) {
+        if ((mode == ScalingMode::STRONG && !options.strong) || (mode == ScalingMode::WEAK && !options.weak)) {
+            continue;
+        }
+
+        SweepPoint single;
+        for (int threads : counts) {
+            int simulations = mode == ScalingMode::STRONG ? options.simulations : options.simulations * threads;
+            SweepPoint point = measure(corpus, threads, simulations, options);
+            if (threads == 1) {
+                single = point;
+            }
+            report(mode, point, single);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Bump allocators for search trees and scratch state
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Consts.hpp"
+
+// Hands out memory by bumping a cursor through chunks that are kept for the
+// life of the arena. Nothing is freed individually: reset() rewinds to the
+// first chunk in O(1) whatever was allocated, and the chunks are reused by the
+// next allocations. An arena is not thread-safe, each thread allocates from
+// its own.
+class Arena {
+public:
+    // Allocations fail once limit bytes have been handed out since the last
+    // reset
+    explicit Arena(size_t chunkSize = ARENA_CHUNK_SIZE, size_t limit = std::numeric_limits<size_t>::max());
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+
+    // Null if the limit would be exceeded
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // Objects are never destroyed, hence trivially destructible only
+    template<class T, class... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        void* memory = allocate(sizeof(T), alignof(T));
+        return memory != nullptr ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    // Default-initialized, so trivial types are left uninitialized
+    template<class T>
+    T* makeArray(size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        void* memory = allocate(sizeof(T) * count, alignof(T));
+        return memory != nullptr ? new (memory) T[count] : nullptr;
+    }
+
+    // Everything allocated is released at once, the chunks are kept
+    void reset();
+    // Also returns the chunks to the system
+    void release();
+
+    // The counters are plain fields, read them while no thread allocates
+    size_t bytesUsed() const;
+    size_t bytesReserved() const;
+    // Most bytes used at once since the arena was created
+    size_t highWaterMark() const;
+
+private:
+    struct Chunk {
+        unsigned char* data;
+        size_t size;
+    };
+
+    bool nextChunk(size_t size, size_t alignment);
+
+    std::vector<Chunk> chunks_;
+    size_t current_;
+    unsigned char* cursor_;
+    unsigned char* end_;
+    size_t chunkSize_;
+    size_t limit_;
+    size_t used_;
+    size_t highWaterMark_;
+};
+
+// One arena per worker of a pool, indexed by ThreadPool::currentWorker(). A
+// worker runs one job at a time, so allocating takes no atomic operation, and
+// the chunks of an arena are first touched by its worker, which places their
+// pages on that worker's NUMA node under the default first-touch policy. A
+// caller allocating from another worker's arena, while that worker is idle,
+// gives this up for the chunks it adds.
+class WorkerArenas {
+public:
+    WorkerArenas(int numberOfWorkers, size_t chunkSize = ARENA_CHUNK_SIZE,
+        size_t limitPerWorker = std::numeric_limits<size_t>::max());
+
+    Arena& operator[](int worker);
+    int size() const;
+    void reset();
+
+    size_t bytesUsed() const;
+    size_t bytesReserved() const;
+    // Sum of the high-water marks of the workers
+    size_t highWaterMark() const;
+
+private:
+    std::vector<std::unique_ptr<Arena>> arenas_;
+};
+
+#endif // !ARENA_H
@@ -0,0 +1,111 @@
+// Searches on a background thread, answered through futures or callbacks
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef ASYNCSOLVER_H
+#define ASYNCSOLVER_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Board.hpp"
+#include "Consts.hpp"
+#include "Policy.hpp"
+
+struct Decision {
+    // Id returned by request(), increasing with every request
+    uint64_t request = 0;
+    // Position the decision is for, callers compare it with their current
+    // one to drop answers that arrive too late
+    Board board;
+    Move move = Move::LEFT;
+    // Values the policy gave to each move, when it keeps any
+    std::array<double, NUMBER_OF_MOVES> values;
+    bool hasValues = false;
+    // Superseded by a newer request or cancelled
+    bool cancelled = false;
+    // False if cancelled before its search started, move is then meaningless
+    bool searched = false;
+    std::chrono::microseconds elapsed{ 0 };
+};
+
+// Owns a thread that runs the searches of a policy, so that the thread asking
+// for a move never blocks. Only the latest position matters to a player: a
+// new request replaces the one still waiting, which is answered as cancelled,
+// and cancel() also flags the search in progress. A search cannot be
+// interrupted, the policy's time budget bounds it.
+//
+// With pondering on, the thread uses its idle time after each decision to
+// search the positions the chosen move can lead to, a 2 then a 4 spawned in
+// every empty cell, for short budgets. Policy::ponder() runs them, filling the
+// policy's caches without counting them as decisions, and the search of the
+// actual next position then starts from those caches.
+// A request waits for at most one of those searches, so pondering suits
+// anytime engines.
+//
+// The policy must not be used by anyone else while the solver exists.
+class AsyncSolver {
+public:
+    using Callback = std::function<void(const Decision&)>;
+
+    explicit AsyncSolver(std::shared_ptr<Policy> policy, bool ponder = false,
+        std::chrono::microseconds ponderBudget = std::chrono::microseconds(PONDER_BUDGET_US));
+    AsyncSolver(const AsyncSolver&) = delete;
+    AsyncSolver& operator=(const AsyncSolver&) = delete;
+    // Futures still waiting are answered as cancelled, callbacks are not called
+    ~AsyncSolver();
+
+    // A zero budget runs the policy's full search. The callback runs on the
+    // solver's thread, or on the caller's for a request that the caller
+    // replaced or cancelled, so a Qt caller forwards it through a queued signal
+    std::future<Decision> request(const Board& board, std::chrono::microseconds budget = std::chrono::microseconds(0));
+    uint64_t request(const Board& board, std::chrono::microseconds budget, Callback callback);
+    void cancel();
+    // Queued like a request, drops the positions left to ponder
+    void newGame();
+
+    uint64_t positionsPondered() const;
+
+private:
+    struct Request {
+        uint64_t id;
+        Board board;
+        std::chrono::microseconds budget;
+        Callback callback;
+        std::promise<Decision> promise;
+    };
+
+    uint64_t enqueue(const Board& board, std::chrono::microseconds budget, Callback callback, std::promise<Decision> promise);
+    static void deliver(Request& request, const Decision& decision, bool callBack);
+    static void deliverCancelled(Request& request, bool callBack);
+    Decision search(const Request& request);
+    void queuePonderPositions(const Board& board, Move move);
+    void run();
+
+    std::shared_ptr<Policy> policy_;
+    const bool ponder_;
+    const std::chrono::microseconds ponderBudget_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::unique_ptr<Request> pending_;
+    std::deque<Board> ponderPositions_;
+    uint64_t nextId_ = 1;
+    // Requests up to this id are answered as cancelled
+    uint64_t cancelledUpTo_ = 0;
+    uint64_t positionsPondered_ = 0;
+    bool newGame_ = false;
+    bool stop_ = false;
+    // Started last, once every field it reads is initialized
+    std::thread thread_;
+};
+
+#endif // !ASYNCSOLVER_H
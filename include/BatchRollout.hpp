@@ -0,0 +1,27 @@
+// Rollouts played on several boards in lockstep with SIMD move kernels
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef BATCHROLLOUT_H
+#define BATCHROLLOUT_H
+
+#include "Board.hpp"
+#include "MonteCarlo.hpp"
+#include "Random.hpp"
+
+// Instruction set of the kernel sliding the boards of a batch, PORTABLE runs
+// the same lockstep loop with the scalar row tables
+enum class BatchIsa { PORTABLE = 0, AVX2 = 1, AVX512 = 2 };
+
+// Widest kernel the running CPU supports, detected once
+BatchIsa bestBatchIsa();
+bool batchIsaSupported(BatchIsa isa);
+int batchLanes(BatchIsa isa);
+
+// Same contract as runSimulations(): plays numberOfSimulations rollouts after
+// currentMove and sums their final scores. A lane whose game ends is refilled
+// with the next rollout so that the vector stays busy until the last games.
+RolloutStats runSimulationsBatched(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen);
+RolloutStats runSimulationsBatched(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen, BatchIsa isa);
+
+#endif // !BATCHROLLOUT_H
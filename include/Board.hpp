@@ -0,0 +1,127 @@
+// Lightweight board used by the solver, independent from Qt
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+#include "Consts.hpp"
+#include "MoveTables.hpp"
+#include "Random.hpp"
+
+enum class Move { LEFT = 0, RIGHT = 1, UP = 2, DOWN = 3 };
+constexpr int NUMBER_OF_MOVES = 4;
+
+// Grid plus score, cheap to copy so that rollouts can work on it by value
+struct Board {
+    Grid grid = 0;
+    int score = 0;
+};
+
+static_assert(std::is_trivially_copyable<Board>::value, "Board must stay trivially copyable");
+
+inline Grid moveGrid(Grid grid, Move move, uint32_t& score) {
+    switch (move) {
+    case Move::LEFT:
+        return moveRowsLeft(grid, score);
+    case Move::RIGHT:
+        return moveRowsRight(grid, score);
+    case Move::UP:
+        return transposeGrid(moveRowsLeft(transposeGrid(grid), score));
+    case Move::DOWN:
+        return transposeGrid(moveRowsRight(transposeGrid(grid), score));
+    default:
+        return grid;
+    }
+}
+
+// Slides the tiles without spawning a new one, returns false if nothing moved
+inline bool applyMove(Board& board, Move move) {
+    uint32_t gainedScore = 0;
+    Grid movedGrid = moveGrid(board.grid, move, gainedScore);
+    if (movedGrid == board.grid) {
+        return false;
+    }
+
+    board.grid = movedGrid;
+    board.score += static_cast<int>(gainedScore);
+    return true;
+}
+
+// One bit set at the low bit of every empty nibble
+inline Grid emptyCellMask(Grid grid) {
+    Grid occupied = grid | (grid >> 1);
+    occupied |= occupied >> 2;
+    return ~occupied & 0x1111111111111111ULL;
+}
+
+inline int countEmptyCells(Grid grid) {
+    return __builtin_popcountll(emptyCellMask(grid));
+}
+
+constexpr uint32_t FOUR_TILE_THRESHOLD = static_cast<uint32_t>(FOUR_TILE_PROBABILITY * 4294967296.0);
+
+// Picks the empty cell and the tile value from a single 64-bit draw
+template<class Generator>
+bool addRandomTile(Board& board, Generator& gen) {
+    Grid emptyMask = emptyCellMask(board.grid);
+    if (emptyMask == 0) {
+        return false;
+    }
+
+    uint64_t random = gen();
+    uint32_t target = scaleToBound(static_cast<uint32_t>(random >> 32), __builtin_popcountll(emptyMask));
+    Grid tile = (static_cast<uint32_t>(random) < FOUR_TILE_THRESHOLD) ? 2 : 1;
+
+    board.grid |= tile << selectBit(emptyMask, target);
+    return true;
+}
+
+// Slides the tiles and spawns a new one if the move was valid
+template<class Generator>
+bool playMove(Board& board, Move move, Generator& gen) {
+    if (!applyMove(board, move)) {
+        return false;
+    }
+
+    addRandomTile(board, gen);
+    return true;
+}
+
+template<class Generator>
+Board newBoard(Generator& gen) {
+    Board board;
+    addRandomTile(board, gen);
+    addRandomTile(board, gen);
+    return board;
+}
+
+// Bit m set if Move m changes the grid, one table lookup per row and per
+// column, without sliding the tiles or drawing a spawn
+inline int legalMoves(Grid grid) {
+    const uint8_t* movable = moveTables().movable;
+    Grid transposed = transposeGrid(grid);
+    int rows = movable[grid & ROW_MASK] | movable[(grid >> 16) & ROW_MASK]
+        | movable[(grid >> 32) & ROW_MASK] | movable[grid >> 48];
+    int columns = movable[transposed & ROW_MASK] | movable[(transposed >> 16) & ROW_MASK]
+        | movable[(transposed >> 32) & ROW_MASK] | movable[transposed >> 48];
+    return rows | (columns << 2);
+}
+
+inline bool isMoveLegal(int legal, Move move) {
+    return (legal >> static_cast<int>(move)) & 1;
+}
+
+inline bool isGameOver(Grid grid) {
+    return legalMoves(grid) == 0;
+}
+
+bool reached2048(Grid grid);
+
+std::ostream& operator<<(std::ostream& os, const Board& board);
+
+#endif // !BOARD_H
@@ -5,12 +5,30 @@
 #ifndef CONSTS_H
 #define CONSTS_H
 
+#include <cstddef>
+
 constexpr int SPACEBAR_CHAR = 32;
 constexpr int NUMBER_OF_SIMULATIONS_PER_MOVE = 300;
 constexpr int DEPTH = 2000;
+constexpr int TRUNCATED_ROLLOUT_DEPTH = 30;
+constexpr double ROLLOUT_EPSILON = 0.1;
+constexpr double DOMINANCE_THRESHOLD = 2.5;
+constexpr int ANYTIME_BATCH_SIZE = 4;
+constexpr int MOVE_TIME_BUDGET_US = 15000;
+constexpr int PONDER_BUDGET_US = 2000;
+constexpr int EXPECTIMAX_DEPTH = 3;
+constexpr int EXPECTIMAX_MAX_DEPTH = 10;
+constexpr double EXPECTIMAX_PROBABILITY_CUTOFF = 0.0001;
+constexpr int MCTS_ITERATIONS = 1200;
+constexpr double MCTS_EXPLORATION = 2.0;
+constexpr int MCTS_VIRTUAL_LOSS = 3;
+constexpr size_t MCTS_MAX_NODES = size_t(1) << 18;
+constexpr size_t ARENA_CHUNK_SIZE = size_t(1) << 20;
+constexpr size_t TRANSPOSITION_TABLE_SIZE_MB = 64;
 constexpr int DELAY = 20;
 constexpr int WINDOW_SIZE = 500;
 constexpr int GRID_SPACING = 10;
 constexpr int GRID_SIZE = 4;
+constexpr double FOUR_TILE_PROBABILITY = 0.1;
 
 #endif // CONSTS_H
\ No newline at end of file
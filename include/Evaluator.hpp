@@ -0,0 +1,18 @@
+// Static evaluation of a board used at the leaves of the searches
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include "MoveTables.hpp"
+
+// Estimates the score still to be gained from an afterstate, the grid left by
+// a move before the new tile spawns
+class Evaluator {
+public:
+    virtual ~Evaluator() = default;
+    virtual double evaluate(Grid grid) const = 0;
+};
+
+#endif // !EVALUATOR_H
@@ -0,0 +1,61 @@
+// Expectimax search to compute the best move at each state
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef EXPECTIMAX_H
+#define EXPECTIMAX_H
+
+#include <array>
+#include <chrono>
+
+#include "Board.hpp"
+#include "Consts.hpp"
+#include "Evaluator.hpp"
+#include "Symmetry.hpp"
+#include "TranspositionTable.hpp"
+
+struct ExpectimaxOptions {
+    // Number of moves looked ahead
+    int depth = EXPECTIMAX_DEPTH;
+    // Chance outcomes reached with a lower probability are not expanded
+    double probabilityCutoff = EXPECTIMAX_PROBABILITY_CUTOFF;
+    // Deepest iteration of the time-budgeted search
+    int maxDepth = EXPECTIMAX_MAX_DEPTH;
+    // Cache chance nodes under their canonical grid so that the eight
+    // symmetric positions share one entry, which requires an evaluator valuing
+    // them alike as the heuristic and the n-tuple network do. Off by default:
+    // past the opening symmetric positions rarely meet within a search, and
+    // canonicalizing every chance node costs more than the hits it adds.
+    bool canonicalKeys = false;
+};
+
+// Max nodes choose among the legal moves, chance nodes average over every
+// empty cell receiving a 2 or a 4. A line is valued by the score it gains,
+// plus the value of its last afterstate when an evaluator is given.
+// Chance node values are cached in the optional table, keyed by their grid.
+class Expectimax {
+public:
+    explicit Expectimax(ExpectimaxOptions options = ExpectimaxOptions(), TranspositionTable* table = nullptr,
+        const Evaluator* evaluator = nullptr);
+    Move bestMove(const Board& board);
+    // Iterative deepening until the budget is spent, returns the best move of
+    // the deepest iteration that completed
+    Move bestMove(const Board& board, std::chrono::microseconds budget);
+    std::array<double, NUMBER_OF_MOVES> evaluateMoves(Grid grid);
+    std::array<double, NUMBER_OF_MOVES> evaluateMoves(Grid grid, int depth);
+
+private:
+    double maxNode(Grid grid, int depth, double probability);
+    double chanceNode(Grid grid, int depth, double probability);
+    bool outOfTime();
+
+    ExpectimaxOptions options_;
+    TranspositionTable* table_;
+    const Evaluator* evaluator_;
+    bool timed_;
+    bool aborted_;
+    uint64_t nodes_;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+#endif // !EXPECTIMAX_H
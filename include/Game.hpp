@@ -16,11 +16,9 @@
 #include <vector>
 #include <gtest/gtest.h>
 
+#include "Board.hpp"
 #include "Consts.hpp"
 
-using Grid = uint64_t;
-enum class Move { LEFT = 0, RIGHT = 1, UP = 2, DOWN = 3 };
-
 struct Compare {
 	bool operator() (const int& a, const int& b) const {
 		return a > b;
@@ -31,6 +29,7 @@ class Game : public QObject {
 	Q_OBJECT
 public:
 	Game();
+	explicit Game(uint64_t seed);
 	Game(const Game& other);
 	bool moveLeft();
 	bool moveRight();
@@ -38,9 +37,12 @@ public:
 	bool moveDown();
 	int getScore();
 	Grid getGrid();
+	const Board& getBoard() const;
 	void setGrid(Grid grid); //TODO: set as private
 	int getGridSize();
 	bool isGameOver();
+	// Bit m set if Move m is legal, see ::legalMoves()
+	int legalMoves();
 	bool reached2048();
 	bool makeMove(Move move); // TODO: set as private
 
@@ -48,16 +50,10 @@ public slots:
 	void handleKeyPress(char key, Move bestMove, std::shared_ptr<Game> game);
 
 private:
-	bool merge();
-	bool compress();
-	void flip();
-	void transpose();
 	bool addTile();
 
-	Grid grid_;
-	int score_;
-	std::random_device rd_;
-	std::ranlux48 gen_;
+	Board board_;
+	Rng gen_;
 
 	friend bool operator==(const Game& left, const Game& right);
 	friend std::ostream& operator<<(std::ostream& os, const Game& game);
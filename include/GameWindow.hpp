@@ -16,15 +16,25 @@
 #include <QIcon>
 #include <QTimer>
 
+#include <chrono>
+#include <memory>
+
+#include "AsyncSolver.hpp"
 #include "Consts.hpp"
-#include "MonteCarlo.hpp"
+#include "Game.hpp"
+#include "Policy.hpp"
+
+Q_DECLARE_METATYPE(Decision)
 
 class GameWindow : public QWidget
 {
     Q_OBJECT
 
 public:
-    GameWindow(QWidget* parent, std::shared_ptr<Game> game, bool autoplay = false);
+    // The policy searches on its own thread and must not be used elsewhere,
+    // ponder lets it search the likely next positions between moves
+    GameWindow(QWidget* parent, std::shared_ptr<Game> game, std::shared_ptr<Policy> policy, bool autoplay = false,
+        bool ponder = false);
     void setupWindow();
     void updateGrid();
     void startAutoPlay();
@@ -34,6 +44,8 @@ protected:
 
 signals:
     void keyPressed(char key, Move bestMove, std::shared_ptr<Game> game);
+    // Emitted by the solver's thread, connected queued to playDecision()
+    void decisionReady(Decision decision);
 
 private:
     void setupGrid();
@@ -41,10 +53,15 @@ private:
     void setWindowSize();
     void setLabelStyle(QLabel* label, int value);
     void autoPlayMove();
+    void requestMove(std::chrono::microseconds budget);
+    void playDecision(const Decision& decision);
 
 private:
     std::shared_ptr<Game> game_;
     std::vector<std::vector<QLabel*>> gridLabels;
+    std::unique_ptr<AsyncSolver> solver_;
+    // Request whose decision will be played, 0 when none is awaited
+    uint64_t awaitedRequest_ = 0;
 };
 
 #endif // GAMEWINDOW_H
\ No newline at end of file
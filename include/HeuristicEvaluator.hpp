@@ -0,0 +1,55 @@
+// Hand-tuned board heuristics precomputed per row
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef HEURISTICEVALUATOR_H
+#define HEURISTICEVALUATOR_H
+
+#include <vector>
+
+#include "Evaluator.hpp"
+#include "MoveTables.hpp"
+
+// Terms are computed on the tile exponents of a line, the defaults are the
+// weights commonly used by expectimax players
+struct HeuristicWeights {
+    // Constant per line so that any position is worth more than a lost one
+    double alive = 200000.0;
+    double emptyCells = 270.0;
+    // Adjacent equal tiles, ignoring the gaps between them
+    double merges = 700.0;
+    // Penalty on the smaller of the increasing and decreasing violations
+    double monotonicity = 47.0;
+    double monotonicityPower = 4.0;
+    // Penalty on the exponent differences of adjacent tiles
+    double smoothness = 0.0;
+    // Penalty on the sum of the exponents raised to sumPower
+    double sum = 11.0;
+    double sumPower = 3.5;
+    // Bonus on the largest tile of a border line when it sits at one end
+    double corner = 0.0;
+};
+
+// Every line of the board is scored by one lookup in a table indexed by the
+// 16-bit row, the four rows and the four columns of the transposed grid. The
+// border lines use a second table that adds the corner term, so a board costs
+// 8 lookups whatever the weights.
+class HeuristicEvaluator : public Evaluator {
+public:
+    explicit HeuristicEvaluator(HeuristicWeights weights = HeuristicWeights());
+
+    double evaluate(Grid grid) const override;
+
+    const HeuristicWeights& weights() const;
+    // Rebuilds the tables, must not run while another thread evaluates
+    void setWeights(const HeuristicWeights& weights);
+
+private:
+    void buildTables();
+
+    HeuristicWeights weights_;
+    std::vector<float> innerLines_;
+    std::vector<float> borderLines_;
+};
+
+#endif // !HEURISTICEVALUATOR_H
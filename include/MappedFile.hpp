@@ -0,0 +1,31 @@
+// Read-only memory mapping of a whole file
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// With copyOnWrite the pages can be modified, the changes stay private to the
+// process and a page is only copied the first time it is written
+class MappedFile {
+public:
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::string& path, bool copyOnWrite = false);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const unsigned char* data() const;
+    // Only valid for a copy-on-write mapping
+    unsigned char* mutableData();
+    size_t size() const;
+
+private:
+    unsigned char* data_;
+    size_t size_;
+};
+
+#endif // !MAPPEDFILE_H
@@ -0,0 +1,128 @@
+// Monte Carlo tree search with chance nodes for the tile spawns
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Arena.hpp"
+#include "Board.hpp"
+#include "Consts.hpp"
+#include "MonteCarlo.hpp"
+#include "Random.hpp"
+#include "ThreadPool.hpp"
+
+// Root parallelism grows one tree per thread and sums their root statistics,
+// tree parallelism grows a single tree shared by every thread
+enum class MctsParallelism { ROOT = 0, TREE = 1 };
+
+struct MctsOptions {
+    // Playouts per move, shared among the threads
+    int iterations = MCTS_ITERATIONS;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = randomSeed();
+    MctsParallelism parallelism = MctsParallelism::TREE;
+    // UCT constant, the values being divided by the mean value of the parent
+    double exploration = MCTS_EXPLORATION;
+    // Visits added to a move while a playout runs below it, so that the other
+    // threads of a shared tree explore elsewhere
+    int virtualLoss = MCTS_VIRTUAL_LOSS;
+    // Nodes of the tree, split among the trees under root parallelism and
+    // among the arenas of the workers growing a shared tree
+    size_t maxNodes = MCTS_MAX_NODES;
+    // Keep the subtree of the position actually reached for the next search
+    bool reuseTree = true;
+    // Plays out the new leaves
+    RolloutOptions rollout;
+};
+
+struct MctsResult {
+    Move move = Move::LEFT;
+    // Mean score gained after each move, -infinity if illegal or unvisited
+    std::array<double, NUMBER_OF_MOVES> values;
+    std::array<int, NUMBER_OF_MOVES> visits;
+    int playouts = 0;
+    // Visits the root already had from the previous searches
+    int reusedVisits = 0;
+    std::chrono::microseconds elapsed{ 0 };
+};
+
+// Decision nodes hold a position with the player to move, their children are
+// the chance nodes of the afterstates of the legal moves, whose children are
+// the positions reached by each spawn. Children are singly linked lists that
+// only grow, a node being published by a compare-and-swap of its parent's
+// head once it is fully written, so that threads share the tree without locks.
+struct MctsNode {
+    Grid grid;
+    // Sum over the visits of the score gained from this node on
+    std::atomic<double> total;
+    std::atomic<MctsNode*> firstChild;
+    MctsNode* nextSibling;
+    std::atomic<int32_t> visits;
+    // Chance nodes only, the score of the move leading to them
+    uint32_t reward;
+    uint8_t move;
+};
+
+// Search context meant to be kept across the moves of a game, so that the
+// subtree of the position reached is searched further instead of from scratch
+class Mcts {
+public:
+    explicit Mcts(MctsOptions options = MctsOptions());
+
+    Move bestMove(const Board& board);
+    Move bestMove(const Board& board, std::chrono::microseconds budget);
+    MctsResult search(const Board& board);
+    // Plays until the budget is spent instead of a fixed number of playouts
+    MctsResult search(const Board& board, std::chrono::microseconds budget);
+    // Drops the trees, the next position cannot be found in them anyway
+    void newGame();
+    void reseed(uint64_t seed);
+
+    const MctsOptions& options() const;
+    uint64_t playoutsPlayed() const;
+    // Bytes of nodes in every tree, reused ones included
+    size_t bytesUsed() const;
+    size_t bytesReserved() const;
+    // Summed over the trees, each counting the larger of its two generations
+    size_t highWaterMark() const;
+
+private:
+    // A shared tree allocates its nodes from the arena of the worker creating
+    // them, a tree of root parallelism from its single arena, used by the
+    // worker running its task. Two generations of arenas, so that a reused
+    // subtree is compacted from one into the other and the rest of the old
+    // tree is released in O(1).
+    struct Tree {
+        Tree(int numberOfWorkers, size_t limitPerWorker);
+
+        WorkerArenas generations[2];
+        int active;
+        MctsNode* root;
+    };
+
+    MctsResult run(const Board& board, bool timed, std::chrono::steady_clock::time_point deadline);
+    void prepareRoot(Tree& tree, Grid grid);
+    void playout(MctsNode* root, Arena& arena, Rng& gen, std::vector<MctsNode*>& path);
+    MctsNode* expand(Arena& arena, MctsNode* node);
+    MctsNode* select(MctsNode* node, MctsNode* children) const;
+    MctsNode* spawnChild(Arena& arena, MctsNode* chance, Grid grid);
+
+    MctsOptions options_;
+    ThreadPool pool_;
+    std::vector<std::unique_ptr<Tree>> trees_;
+    std::vector<Rng> generators_;
+    std::vector<std::vector<MctsNode*>> paths_;
+    uint64_t playoutsPlayed_ = 0;
+};
+
+#endif // !MCTS_H
@@ -0,0 +1,136 @@
+// Runtime counters and latency histograms of the solver and its pool
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class Counter {
+    DECISIONS = 0,
+    BOOK_HITS = 1,
+    ROLLOUTS = 2,
+    // Moves played by the rollouts, illegal draws excluded
+    MOVES = 3,
+    TABLE_HITS = 4,
+    TABLE_MISSES = 5,
+    // Jobs a pool worker took from the queues, the jobs it runs while waiting
+    // on them count towards their time
+    JOBS = 6,
+    BUSY_NANOSECONDS = 7,
+    IDLE_NANOSECONDS = 8
+};
+
+constexpr int NUMBER_OF_COUNTERS = 9;
+
+enum class MetricsFormat { JSON = 0, PROMETHEUS = 1 };
+
+struct LatencySummary {
+    uint64_t count = 0;
+    std::chrono::nanoseconds total{ 0 };
+    std::chrono::nanoseconds p50{ 0 };
+    std::chrono::nanoseconds p90{ 0 };
+    std::chrono::nanoseconds p99{ 0 };
+    std::chrono::nanoseconds max{ 0 };
+};
+
+// Log-linear buckets, eight per power of two, so a percentile is off by at
+// most 12.5%. Recording is a couple of relaxed atomic adds and any thread may
+// record at any time.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(std::chrono::nanoseconds latency);
+    // Upper bound of the bucket holding quantile q, clamped to the maximum
+    std::chrono::nanoseconds percentile(double q) const;
+    LatencySummary summary() const;
+    // Records running concurrently may land before or after the reset
+    void reset();
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int NUMBER_OF_BUCKETS = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+    static int bucketIndex(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(int index);
+
+    std::array<std::atomic<uint64_t>, NUMBER_OF_BUCKETS> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> total_;
+    std::atomic<uint64_t> max_;
+};
+
+struct MetricsSnapshot {
+    using Counters = std::array<uint64_t, NUMBER_OF_COUNTERS>;
+
+    // Wall time since the metrics were created or reset
+    std::chrono::nanoseconds uptime{ 0 };
+    Counters totals = {};
+    // One entry per thread that recorded anything, in order of first record
+    std::vector<Counters> threads;
+    LatencySummary decisionLatency;
+    // Time jobs submitted from outside the pool waited for a worker
+    LatencySummary queueWait;
+
+    uint64_t total(Counter counter) const;
+    // Over the wall time, and over the time spent inside searches
+    double perSecond(Counter counter) const;
+    double perSearchSecond(Counter counter) const;
+    // Fraction of the table probes that hit, 0 without any probe
+    double tableHitRate() const;
+
+    std::string toJson() const;
+    std::string toPrometheus() const;
+};
+
+// Sink shared by a solver and its pool, or by several solvers. Counters live
+// in one cache line per recording thread, which only that thread writes, and
+// are summed when a snapshot is taken, so recording never contends.
+class Metrics {
+public:
+    Metrics();
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void add(Counter counter, uint64_t amount = 1);
+    void recordDecision(std::chrono::nanoseconds latency);
+    void recordQueueWait(std::chrono::nanoseconds latency);
+
+    MetricsSnapshot snapshot() const;
+    void reset();
+    // Written aside then renamed, so a scraper never reads half a file.
+    // Throws if the file cannot be written
+    void dump(const std::string& path, MetricsFormat format) const;
+
+private:
+    struct alignas(64) ThreadCounters {
+        std::thread::id thread;
+        std::array<std::atomic<uint64_t>, NUMBER_OF_COUNTERS> values;
+    };
+
+    static uint64_t nextId();
+    ThreadCounters& local();
+
+    // Tells a thread's cached slot apart from one of a destroyed instance
+    const uint64_t id_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadCounters>> threads_;
+    LatencyHistogram decisionLatency_;
+    LatencyHistogram queueWait_;
+    std::atomic<int64_t> start_;
+};
+
+// Prometheus text for paths ending in .prom, JSON otherwise
+MetricsFormat metricsFormatForPath(const std::string& path);
+
+#endif // !METRICS_H
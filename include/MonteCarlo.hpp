@@ -13,12 +13,46 @@
 #include <random>
 #include <mutex>
 #include "Consts.hpp"
-#include "Game.hpp"
+#include "Board.hpp"
+#include "Evaluator.hpp"
+#include "Random.hpp"
 #include "ThreadPool.hpp"
+#include "TranspositionTable.hpp"
 
-std::unique_ptr<Game> move(const Game& game, Move move);
-double simulate(std::unique_ptr<Game> game, std::ranlux48& localGen);
-double runSimulations(const Game& game, Move currentMove, int numberOfSimulations);
-Move performMC(const Game& game, int numberOfSimulationsPerMove, int numThreads);
+constexpr Grid ROLLOUT_KEY_SALT = 0xA5A5C3C35A5A3C3CULL;
+
+// Sums over a batch of rollouts of their final scores
+struct RolloutStats {
+    double total = 0.0;
+    double totalSquares = 0.0;
+    int count = 0;
+    // Moves the rollouts played, illegal draws excluded
+    uint64_t moves = 0;
+};
+
+// How a rollout picks its moves. Uniform draws among the four moves, illegal
+// ones included, the others only consider the legal moves. Greedy plays the
+// move maximizing the score gained plus the evaluation of the afterstate, and
+// epsilon-greedy does the same except for a random legal move now and then.
+// Greedy ties go to the first move in LEFT, RIGHT, UP, DOWN order.
+enum class RolloutPolicy { UNIFORM = 0, LEGAL_RANDOM = 1, GREEDY = 2, EPSILON_GREEDY = 3 };
+
+struct RolloutOptions {
+    RolloutPolicy policy = RolloutPolicy::UNIFORM;
+    // Moves played before the rollout is cut off
+    int depth = DEPTH;
+    double epsilon = ROLLOUT_EPSILON;
+    // Ranks the greedy moves and adds its value of the final position to the
+    // score of a rollout that was cut off, null to use the score alone
+    const Evaluator* evaluator = nullptr;
+};
+
+Board move(const Board& board, Move move, Rng& localGen);
+double simulate(Board board, Rng& localGen);
+double simulate(Board board, Rng& localGen, const RolloutOptions& options);
+RolloutStats runSimulations(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen);
+RolloutStats runSimulations(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen, const RolloutOptions& options);
+// One-shot search, a Solver should be kept instead when searching repeatedly
+Move performMC(const Board& board, int numberOfSimulationsPerMove, int numThreads, uint64_t seed = randomSeed(), TranspositionTable* table = nullptr);
 
 #endif // !MONTECARLO_H
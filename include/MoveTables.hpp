@@ -0,0 +1,82 @@
+// Precomputed row tables used to execute moves on a packed grid
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef MOVETABLES_H
+#define MOVETABLES_H
+
+#include <cstdint>
+
+#include "Consts.hpp"
+
+using Grid = uint64_t;
+using Row = uint16_t;
+
+constexpr int ROW_BITS = 16;
+constexpr int NUMBER_OF_ROWS = 1 << ROW_BITS;
+constexpr Grid ROW_MASK = 0xFFFFULL;
+
+// For every possible 16-bit row (column 0 in the low nibble), the row obtained
+// by sliding it left or right and the score gained by the merges. The score is
+// the same in both directions since a run of equal tiles always yields the
+// same number of merges.
+struct MoveTables {
+    MoveTables();
+
+    Row left[NUMBER_OF_ROWS];
+    Row right[NUMBER_OF_ROWS];
+    uint32_t score[NUMBER_OF_ROWS];
+    // Left moves then right moves, each entry holding the result row in its low
+    // 16 bits and score / 4 in its high 16 bits so that one gather fetches both
+    uint32_t packed[2 * NUMBER_OF_ROWS];
+    // Bit 0 set if sliding the row left changes it, bit 1 if sliding it right
+    uint8_t movable[NUMBER_OF_ROWS];
+};
+
+const MoveTables& moveTables();
+
+constexpr Grid transposeGrid(Grid grid) {
+    Grid a1 = grid & 0xF0F00F0FF0F00F0FULL;
+    Grid a2 = grid & 0x0000F0F00000F0F0ULL;
+    Grid a3 = grid & 0x0F0F00000F0F0000ULL;
+    Grid a = a1 | (a2 << 12) | (a3 >> 12);
+    Grid b1 = a & 0xFF00FF0000FF00FFULL;
+    Grid b2 = a & 0x00FF00FF00000000ULL;
+    Grid b3 = a & 0x00000000FF00FF00ULL;
+    return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+// Reverses the columns, column 0 becomes column 3
+constexpr Grid mirrorGrid(Grid grid) {
+    Grid nibbles = ((grid & 0xF0F0F0F0F0F0F0F0ULL) >> 4) | ((grid & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return ((nibbles & 0xFF00FF00FF00FF00ULL) >> 8) | ((nibbles & 0x00FF00FF00FF00FFULL) << 8);
+}
+
+// Reverses the rows, row 0 becomes row 3
+constexpr Grid flipGrid(Grid grid) {
+    return (grid >> 48) | ((grid >> 16) & 0x00000000FFFF0000ULL) | ((grid << 16) & 0x0000FFFF00000000ULL) | (grid << 48);
+}
+
+inline Grid moveRowsLeft(Grid grid, uint32_t& score) {
+    const MoveTables& tables = moveTables();
+    Grid result = 0;
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        Row current = static_cast<Row>((grid >> (row * ROW_BITS)) & ROW_MASK);
+        result |= static_cast<Grid>(tables.left[current]) << (row * ROW_BITS);
+        score += tables.score[current];
+    }
+    return result;
+}
+
+inline Grid moveRowsRight(Grid grid, uint32_t& score) {
+    const MoveTables& tables = moveTables();
+    Grid result = 0;
+    for (int row = 0; row < GRID_SIZE; ++row) {
+        Row current = static_cast<Row>((grid >> (row * ROW_BITS)) & ROW_MASK);
+        result |= static_cast<Grid>(tables.right[current]) << (row * ROW_BITS);
+        score += tables.score[current];
+    }
+    return result;
+}
+
+#endif // !MOVETABLES_H
@@ -0,0 +1,70 @@
+// N-tuple network estimating the score still to be gained from a board
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef NTUPLENETWORK_H
+#define NTUPLENETWORK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Evaluator.hpp"
+#include "MappedFile.hpp"
+#include "MoveTables.hpp"
+#include "Symmetry.hpp"
+
+constexpr int MAX_TUPLE_LENGTH = 7;
+
+// Sum of one weight per tuple and per symmetry of the board. A tuple is a set
+// of cells, cell i being nibble i of the grid, and its weight is looked up
+// with the tile exponents of those cells as index. The eight rotations and
+// reflections share the same tables, which learns faster and makes the value
+// symmetric.
+//
+// Weight file: "2048NTN1", u32 version, u32 number of tuples, then one u8
+// length plus seven u8 cells per tuple, zero padded to 64 bytes, then the
+// float tables of the tuples one after the other.
+class NTupleNetwork : public Evaluator {
+public:
+    using Tuple = std::vector<int>;
+
+    // Four 6-tuples of 64 MiB of weights each: the first two rows, each with
+    // two cells of the row below, and two 2x3 rectangles
+    static std::vector<Tuple> standardTuples();
+
+    // All weights start at zero, the cells of each tuple are sorted
+    explicit NTupleNetwork(std::vector<Tuple> tuples = standardTuples());
+    // Maps the weights copy-on-write so that loading is instantaneous and the
+    // loaded network can keep training. Throws if the file is not a network
+    static std::unique_ptr<NTupleNetwork> load(const std::string& path);
+    void save(const std::string& path) const;
+
+    double evaluate(Grid grid) const override;
+    // Adds delta to every weight contributing to the value of grid. Several
+    // threads may update at once, a concurrent update can be lost but no
+    // weight is ever torn.
+    void update(Grid grid, float delta);
+
+    const std::vector<Tuple>& tuples() const;
+    // Weights summed by evaluate(), the learning rate is usually divided by it
+    int numberOfFeatures() const;
+    size_t numberOfWeights() const;
+
+private:
+    NTupleNetwork(std::vector<Tuple> tuples, std::unique_ptr<MappedFile> mapping, float* weights);
+    void initializeTuples();
+    size_t tupleIndex(Grid grid, int tuple) const;
+
+    std::vector<Tuple> tuples_;
+    std::vector<uint64_t> masks_;
+    std::vector<size_t> offsets_;
+    size_t numberOfWeights_;
+    std::vector<float> ownedWeights_;
+    std::unique_ptr<MappedFile> mapping_;
+    float* weights_;
+};
+
+#endif // !NTUPLENETWORK_H
@@ -0,0 +1,55 @@
+// Precomputed best moves of frequently reached boards
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef OPENINGBOOK_H
+#define OPENINGBOOK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Board.hpp"
+#include "MappedFile.hpp"
+#include "Symmetry.hpp"
+
+// The value is the score the search expects to gain after playing the move
+struct BookEntry {
+    Grid key;
+    float value;
+    uint32_t move;
+};
+
+static_assert(sizeof(BookEntry) == 16, "BookEntry is the on-disk record");
+
+// Read-only book keyed by canonical grid, so that one entry answers for the
+// eight symmetric positions. Lookups are a binary search over the mapped
+// entries, nothing is copied or parsed when the book is loaded.
+//
+// Book file: "2048OBK1", u32 version, u32 number of entries, then the entries
+// sorted by key, the move being given in the orientation of the key.
+class OpeningBook {
+public:
+    // Throws if the file is not a book
+    static std::unique_ptr<OpeningBook> load(const std::string& path);
+    // Entries may be given in any orientation and order, they are
+    // canonicalized and sorted. When a position appears twice the last entry
+    // wins.
+    static void write(const std::string& path, std::vector<BookEntry> entries);
+
+    // False if the position is not in the book, otherwise the move to play on
+    // grid in its own orientation
+    bool probe(Grid grid, Move& move, float& value) const;
+    size_t size() const;
+
+private:
+    explicit OpeningBook(std::unique_ptr<MappedFile> mapping);
+
+    std::unique_ptr<MappedFile> mapping_;
+    const BookEntry* entries_;
+    size_t size_;
+};
+
+#endif // !OPENINGBOOK_H
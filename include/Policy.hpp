@@ -0,0 +1,133 @@
+// Policies choosing the move to play, one per search engine
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "Board.hpp"
+#include "Evaluator.hpp"
+#include "Expectimax.hpp"
+#include "Mcts.hpp"
+#include "OpeningBook.hpp"
+#include "Solver.hpp"
+#include "TranspositionTable.hpp"
+
+enum class Engine { MONTE_CARLO = 0, EXPECTIMAX = 1, MCTS = 2 };
+
+class Policy {
+public:
+    virtual ~Policy() = default;
+    virtual Move bestMove(const Board& board) = 0;
+    // Returns within about the given budget, engines without an anytime mode
+    // ignore it
+    virtual Move bestMove(const Board& board, std::chrono::microseconds budget) {
+        (void)budget;
+        return bestMove(board);
+    }
+    // Searches a position that may come up so that the engine's caches hold
+    // it, without counting it as a decision. Engines recording nothing per
+    // decision just search it
+    virtual void ponder(const Board& board, std::chrono::microseconds budget) {
+        bestMove(board, budget);
+    }
+    // Called when a new game starts, drops what was cached for the previous one
+    virtual void newGame() {}
+    // Restarts the random streams of engines that use any, deterministic
+    // engines ignore it
+    virtual void reseed(uint64_t seed) {
+        (void)seed;
+    }
+    // Rollouts played so far, 0 for engines that do not play any
+    virtual uint64_t rolloutsPlayed() const {
+        return 0;
+    }
+    // Values the last search gave to each move, false if the engine keeps none
+    virtual bool lastValues(std::array<double, NUMBER_OF_MOVES>& values) const {
+        (void)values;
+        return false;
+    }
+};
+
+class MonteCarloPolicy : public Policy {
+public:
+    // The evaluator and the book are kept alive for options.rollout.evaluator
+    // and options.book to point to, a book given here replaces options.book
+    explicit MonteCarloPolicy(SolverOptions options = SolverOptions(), std::shared_ptr<const Evaluator> evaluator = nullptr,
+        std::shared_ptr<const OpeningBook> book = nullptr);
+    Move bestMove(const Board& board) override;
+    Move bestMove(const Board& board, std::chrono::microseconds budget) override;
+    // Leaves the last values alone
+    void ponder(const Board& board, std::chrono::microseconds budget) override;
+    void newGame() override;
+    void reseed(uint64_t seed) override;
+    uint64_t rolloutsPlayed() const override;
+    bool lastValues(std::array<double, NUMBER_OF_MOVES>& values) const override;
+
+private:
+    std::shared_ptr<const Evaluator> evaluator_;
+    std::shared_ptr<const OpeningBook> book_;
+    Solver solver_;
+    SearchResult lastResult_;
+    bool hasValues_ = false;
+};
+
+class ExpectimaxPolicy : public Policy {
+public:
+    // Positions found in the book are played without searching
+    explicit ExpectimaxPolicy(ExpectimaxOptions options = ExpectimaxOptions(),
+        std::shared_ptr<const Evaluator> evaluator = nullptr, std::shared_ptr<const OpeningBook> book = nullptr,
+        size_t tableSizeInMegabytes = TRANSPOSITION_TABLE_SIZE_MB);
+    Move bestMove(const Board& board) override;
+    Move bestMove(const Board& board, std::chrono::microseconds budget) override;
+    void newGame() override;
+
+private:
+    std::shared_ptr<const Evaluator> evaluator_;
+    std::shared_ptr<const OpeningBook> book_;
+    TranspositionTable table_;
+    Expectimax expectimax_;
+};
+
+class MctsPolicy : public Policy {
+public:
+    // The evaluator is kept alive for options.rollout.evaluator to point to,
+    // positions found in the book are played without searching
+    explicit MctsPolicy(MctsOptions options = MctsOptions(), std::shared_ptr<const Evaluator> evaluator = nullptr,
+        std::shared_ptr<const OpeningBook> book = nullptr);
+    Move bestMove(const Board& board) override;
+    Move bestMove(const Board& board, std::chrono::microseconds budget) override;
+    void newGame() override;
+    void reseed(uint64_t seed) override;
+    uint64_t rolloutsPlayed() const override;
+    bool lastValues(std::array<double, NUMBER_OF_MOVES>& values) const override;
+
+private:
+    Move keep(const Board& board, const MctsResult& result);
+
+    std::shared_ptr<const Evaluator> evaluator_;
+    std::shared_ptr<const OpeningBook> book_;
+    Mcts mcts_;
+    // Final scores as for the other engines, the tree stores score gains
+    std::array<double, NUMBER_OF_MOVES> lastValues_;
+    bool hasValues_ = false;
+};
+
+// The evaluator, if any, scores the leaves of the engines that use one, the
+// book answers the positions it holds before any search
+std::unique_ptr<Policy> makePolicy(Engine engine, int numThreads, std::shared_ptr<const Evaluator> evaluator = nullptr,
+    std::shared_ptr<const OpeningBook> book = nullptr);
+// Monte Carlo settings of makePolicy(): with an evaluator the rollouts are
+// short and greedy
+SolverOptions monteCarloOptions(int numThreads, const Evaluator* evaluator);
+bool parseEngine(const std::string& name, Engine& engine);
+// "heuristic" for the default heuristic evaluator, otherwise the path of an
+// n-tuple network. Throws if the network cannot be loaded
+std::shared_ptr<const Evaluator> makeEvaluator(const std::string& name);
+
+#endif // !POLICY_H
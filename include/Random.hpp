@@ -0,0 +1,114 @@
+// Fast pseudo random number generators used by the rollouts and tile spawns
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+// Used to seed the other generators, every seed gives a well mixed stream
+class SplitMix64 {
+public:
+    using result_type = uint64_t;
+
+    explicit SplitMix64(uint64_t seed) : state_(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state_;
+};
+
+// xoshiro256** by Blackman and Vigna, the default generator of the solver
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed) {
+        SplitMix64 seeder(seed);
+        for (uint64_t& word : state_) {
+            word = seeder();
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        const uint64_t t = state_[1] << 17;
+
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+
+        return result;
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t state_[4];
+};
+
+using Rng = Xoshiro256;
+
+// Nondeterministic seed for when the caller does not need reproducible runs
+inline uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+// Seed of the index-th independent stream derived from a base seed
+inline uint64_t deriveSeed(uint64_t seed, uint64_t index) {
+    SplitMix64 mixer(seed ^ (index * 0xD1B54A32D192ED03ULL));
+    return mixer();
+}
+
+// Maps a 32-bit random value to [0, bound) with a multiply-shift, the bias is
+// at most bound / 2^32 which is negligible for the small bounds used here
+inline uint32_t scaleToBound(uint32_t random, uint32_t bound) {
+    return static_cast<uint32_t>((static_cast<uint64_t>(random) * bound) >> 32);
+}
+
+// Works with any generator producing 64 random bits per call
+template<class Generator>
+uint32_t randomBelow(Generator& gen, uint32_t bound) {
+    static_assert(Generator::max() == std::numeric_limits<uint64_t>::max() && Generator::min() == 0,
+        "randomBelow needs a generator producing 64 random bits");
+    return scaleToBound(static_cast<uint32_t>(gen() >> 32), bound);
+}
+
+// Position of the index-th set bit of mask, index being zero based
+inline int selectBit(uint64_t mask, int index) {
+#if defined(__BMI2__)
+    return __builtin_ctzll(_pdep_u64(1ULL << index, mask));
+#else
+    for (int i = 0; i < index; ++i) {
+        mask &= mask - 1;
+    }
+    return __builtin_ctzll(mask);
+#endif
+}
+
+#endif // !RANDOM_H
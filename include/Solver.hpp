@@ -0,0 +1,156 @@
+// Long-lived solver reusing its workers, generators and caches across moves
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BatchRollout.hpp"
+#include "Board.hpp"
+#include "Consts.hpp"
+#include "Metrics.hpp"
+#include "MonteCarlo.hpp"
+#include "OpeningBook.hpp"
+#include "Random.hpp"
+#include "Symmetry.hpp"
+#include "TranspositionTable.hpp"
+
+// How the rollouts are shared among the legal root moves. Uniform gives every
+// move the same budget, successive halving spends it in rounds and keeps the
+// better half of the moves after each round.
+enum class RootAllocation { UNIFORM = 0, SUCCESSIVE_HALVING = 1 };
+
+struct SolverOptions {
+    int numberOfSimulationsPerMove = NUMBER_OF_SIMULATIONS_PER_MOVE;
+    int numThreads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = randomSeed();
+    // Size of the table owned by the solver, 0 to run without one
+    size_t tableSizeInMegabytes = TRANSPOSITION_TABLE_SIZE_MB;
+    RootAllocation rootAllocation = RootAllocation::SUCCESSIVE_HALVING;
+    // Stop early once the leader is this many standard errors above every other move
+    double dominanceThreshold = DOMINANCE_THRESHOLD;
+    // Play the rollouts of a task in lockstep with the widest SIMD kernel
+    // available, only used with uniform rollouts played to DEPTH
+    bool batchedRollouts = true;
+    RolloutOptions rollout;
+    // Cache rollout means under the canonical afterstate, symmetric
+    // afterstates then pool their rollouts in one entry
+    bool canonicalKeys = true;
+    // Positions found in the book are answered without searching, the book
+    // must outlive the solver
+    const OpeningBook* book = nullptr;
+    // Sink of the solver and pool metrics, several solvers may share one to
+    // aggregate them as long as it outlives them. Null for a sink owned by
+    // the solver
+    Metrics* metrics = nullptr;
+    // Bind each worker to its own CPU, for measurements that must not depend
+    // on where the scheduler moves them
+    bool pinThreads = false;
+};
+
+struct SearchResult {
+    Move move = Move::LEFT;
+    // Mean final score of the rollouts after each move, -infinity if illegal
+    std::array<double, NUMBER_OF_MOVES> values;
+    // Rollouts played after each move during this search
+    std::array<int, NUMBER_OF_MOVES> rollouts;
+    int rounds = 0;
+    std::chrono::microseconds elapsed{ 0 };
+    // The move came from the book, only its own value is known
+    bool fromBook = false;
+};
+
+// Monte Carlo search context meant to be created once and reused across moves
+// and games, so that the decision path never spawns or joins threads
+class Solver {
+public:
+    explicit Solver(SolverOptions options = SolverOptions(), TranspositionTable* sharedTable = nullptr);
+
+    Move bestMove(Grid grid);
+    Move bestMove(const Board& board);
+    SearchResult search(const Board& board);
+    // Anytime search, plays rounds of rollouts until the budget is spent and
+    // returns the best move found so far
+    Move bestMove(Grid grid, std::chrono::microseconds budget);
+    SearchResult search(const Board& board, std::chrono::microseconds budget);
+    // Anytime search of a position that may come up, only to fill the table.
+    // Skips the book and records no decision, its rollouts and probes are
+    // still counted
+    void ponder(const Board& board, std::chrono::microseconds budget);
+    // Fixed-budget searches of many independent positions, with a score of
+    // 0. Every board is searched by a single task and the boards are spread
+    // over the pool, so the workers synchronize once per batch instead of
+    // once per round of every board. The table is neither probed nor filled,
+    // so that a result only depends on the seed, the batches searched before
+    // and the board's index, whatever the thread count and the batch size
+    std::vector<SearchResult> searchBatch(const Grid* grids, size_t count);
+    std::vector<SearchResult> searchBatch(const std::vector<Grid>& grids);
+    void newGame();
+    // Restarts the rollout generators from a new seed, for reproducible games
+    void reseed(uint64_t seed);
+
+    const SolverOptions& options() const;
+    // Rollouts played since the solver was created
+    uint64_t rolloutsPlayed() const;
+    TranspositionTable* table();
+    // Always recording: decision latencies, rollouts and their moves, table
+    // probes and the time the pool's workers spend busy, asleep and queued
+    Metrics& metrics();
+
+private:
+    struct MoveStatistics {
+        Board afterBoard;
+        double total;
+        double totalSquares;
+        int count;
+        int rollouts;
+        // Enough rollouts were cached, no new ones are played
+        bool frozen;
+
+        double mean() const;
+        // Standard deviation of the rollouts
+        double deviation() const;
+        double standardError() const;
+    };
+
+    using Statistics = std::array<MoveStatistics, NUMBER_OF_MOVES>;
+
+    // The table may be null to search without one
+    SearchResult searchFixed(const Board& board, Statistics& statistics, Rng* gen, TranspositionTable* table);
+    SearchResult searchAnytime(const Board& board, std::chrono::microseconds budget);
+    void recordDecision(const SearchResult& result);
+    bool probeBook(const Board& board, SearchResult& result);
+    std::vector<int> prepareSearch(const Board& board, Statistics& statistics, TranspositionTable* table);
+    SearchResult finishSearch(const Board& board, const Statistics& statistics, const std::vector<int>& candidates,
+        int rounds, std::chrono::steady_clock::time_point start, TranspositionTable* table);
+    // Rollouts are played on the pool, or on the calling thread with gen when
+    // it is not null
+    bool runRound(const Board& board, Statistics& statistics, const std::vector<int>& candidates, int rolloutsPerCandidate,
+        Rng* gen);
+    void eliminateDominated(const Statistics& statistics, std::vector<int>& candidates) const;
+
+    SolverOptions options_;
+    // Declared before the pool, whose workers record to it until joined
+    std::unique_ptr<Metrics> ownedMetrics_;
+    Metrics* metrics_;
+    ThreadPool pool_;
+    // One generator per task slot, each task owns its slot during a search
+    std::vector<Rng> generators_;
+    std::unique_ptr<TranspositionTable> ownedTable_;
+    TranspositionTable* table_;
+    std::vector<RolloutStats> taskStats_;
+    Statistics statistics_;
+    // Batch tasks add to it concurrently
+    std::atomic<uint64_t> rolloutsPlayed_{ 0 };
+    uint64_t batchesSearched_ = 0;
+};
+
+#endif // !SOLVER_H
@@ -0,0 +1,57 @@
+// Dihedral symmetries of the board and canonical grid keys
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "Board.hpp"
+#include "MoveTables.hpp"
+
+constexpr int NUMBER_OF_SYMMETRIES = 8;
+
+// Symmetry s transposes the grid if bit 2 is set, then reverses its rows if
+// bit 1 is set, then its columns if bit 0 is set. Symmetry 0 is the identity.
+constexpr Grid applySymmetry(Grid grid, int symmetry) {
+    grid = (symmetry & 4) != 0 ? transposeGrid(grid) : grid;
+    grid = (symmetry & 2) != 0 ? flipGrid(grid) : grid;
+    return (symmetry & 1) != 0 ? mirrorGrid(grid) : grid;
+}
+
+// The symmetry undoing s. Reversing the rows before a transposition is the
+// same as reversing the columns after it, hence the swap.
+constexpr int inverseSymmetry(int symmetry) {
+    return (symmetry & 4) != 0 ? 4 | ((symmetry & 1) << 1) | ((symmetry & 2) >> 1) : symmetry;
+}
+
+// The move on the transformed grid that has the same effect as move on the
+// original one: applySymmetry(moveGrid(g, m), s) == moveGrid(applySymmetry(g, s),
+// symmetricMove(m, s))
+constexpr Move symmetricMove(Move move, int symmetry) {
+    int m = static_cast<int>(move);
+    m = (symmetry & 4) != 0 ? m ^ 2 : m;
+    m = (symmetry & 2) != 0 && m >= 2 ? m ^ 1 : m;
+    m = (symmetry & 1) != 0 && m < 2 ? m ^ 1 : m;
+    return static_cast<Move>(m);
+}
+
+// Smallest of the eight symmetric grids, with the symmetry that produced it.
+// Positions sharing a key are the same position seen from another side, a move
+// chosen on the key is played on the original grid as
+// symmetricMove(move, inverseSymmetry(symmetry)).
+struct CanonicalGrid {
+    Grid key;
+    int symmetry;
+};
+
+CanonicalGrid canonicalGrid(Grid grid);
+
+inline Grid canonicalKey(Grid grid) {
+    return canonicalGrid(grid).key;
+}
+
+// The eight rotations and reflections of a grid, symmetries[s] being
+// applySymmetry(grid, s)
+void symmetricGrids(Grid grid, Grid (&symmetries)[NUMBER_OF_SYMMETRIES]);
+
+#endif // !SYMMETRY_H
@@ -2,45 +2,250 @@
 // Author: Fabrice Renard
 // Date : 30 / 08 / 2024
 
-#include <vector>
-#include <thread>
-#include <queue>
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
 #include <mutex>
-#include <condition_variable>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Metrics.hpp"
 
+// Work-stealing pool: every worker owns a lock-free deque, pops its own jobs
+// from the bottom and steals from the top of the others' when it runs dry.
+// Threads outside the pool submit through a shared injection queue.
+//
+// Only join() and parallelFor() are allocation-free: they keep their jobs on
+// the caller's stack, and a worker waiting on a join keeps executing other jobs
+// instead of blocking. Search code running on the pool can therefore fork
+// recursively. enqueue() is the allocating compatibility path, every call
+// allocates the shared state of its future and the job that carries it.
+//
+// Given a Metrics sink, every worker records the jobs it takes, its time
+// running them and its time asleep, and the pool records how long the jobs
+// submitted from outside waited in the injection queue. Without one the pool
+// reads no clock.
 class ThreadPool {
 public:
-    ThreadPool(size_t);
+    ThreadPool(size_t, Metrics* metrics = nullptr);
     template<class F, class... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
+    template<class A, class B>
+    void join(A&& a, B&& b);
+    template<class F>
+    void parallelFor(int begin, int end, int grain, F&& body);
+    size_t size() const;
+    // Index of the calling worker, -1 on a thread outside the pool. A worker
+    // runs one job at a time, so per-worker state needs no synchronization as
+    // long as the job does not wait on others
+    int currentWorker() const;
+    // Binds worker i to the i-th CPU the process may run on, wrapping around.
+    // False if the platform or the system refused
+    bool pinWorkers();
     ~ThreadPool();
 
 private:
+    struct Job {
+        explicit Job(void (*execute)(Job*)) : execute(execute) {}
+        void (*execute)(Job*);
+        // Only set for injected jobs when the pool records metrics
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    // Job living on the stack of the thread that forked it
+    template<class F>
+    struct StackJob : Job {
+        explicit StackJob(F& f) : Job(&run), f(f), done(false) {}
+
+        static void run(Job* job) {
+            StackJob* self = static_cast<StackJob*>(job);
+            try {
+                self->f();
+            } catch (...) {
+                self->exception = std::current_exception();
+            }
+            self->done.store(true, std::memory_order_release);
+        }
+
+        F& f;
+        std::exception_ptr exception;
+        std::atomic<bool> done;
+    };
+
+    // Job a thread outside the pool blocks on until a worker has run it
+    template<class F>
+    struct BlockingJob : Job {
+        explicit BlockingJob(F& f) : Job(&run), f(f), done(false) {}
+
+        static void run(Job* job) {
+            BlockingJob* self = static_cast<BlockingJob*>(job);
+            try {
+                self->f();
+            } catch (...) {
+                self->exception = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(self->mutex);
+            self->done = true;
+            self->finished.notify_one();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [this] { return done; });
+        }
+
+        F& f;
+        std::exception_ptr exception;
+        std::mutex mutex;
+        std::condition_variable finished;
+        bool done;
+    };
+
+    // Job submitted by enqueue(), allocated per call and deleted once executed
+    template<class Task>
+    struct HeapJob : Job {
+        explicit HeapJob(Task&& task) : Job(&run), task(std::move(task)) {}
+
+        static void run(Job* job) {
+            HeapJob* self = static_cast<HeapJob*>(job);
+            self->task();
+            delete self;
+        }
+
+        Task task;
+    };
+
+    // Chase-Lev deque, only its owner pushes and pops, anyone can steal
+    class WorkStealingDeque {
+    public:
+        static constexpr int64_t CAPACITY = 4096;
+
+        WorkStealingDeque();
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+        bool empty() const;
+
+    private:
+        alignas(64) std::atomic<int64_t> top;
+        alignas(64) std::atomic<int64_t> bottom;
+        std::unique_ptr<std::atomic<Job*>[]> buffer;
+    };
+
+    template<class F>
+    void runOnWorker(F&& f);
+    template<class F>
+    void forRange(int begin, int end, int grain, F& body);
+
+    void submit(Job* job);
+    bool pushLocal(Job* job);
+    void waitUntil(const std::atomic<bool>& done);
+    Job* findJob(int index);
+    bool hasWork() const;
+    bool onWorkerThread() const;
+    void workerLoop(int index);
+
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::deque<Job*> injected;
     std::mutex queue_mutex;
+    std::atomic<size_t> injectedCount;
+    std::mutex sleep_mutex;
     std::condition_variable condition;
-    bool stop;
+    std::atomic<int> sleepers;
+    std::atomic<bool> stop;
+    Metrics* metrics;
 };
 
 template<class F, class... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type> {
     using return_type = typename std::result_of<F(Args...)>::type;
 
-    auto task = std::make_shared<std::packaged_task<return_type()>>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    if (stop.load(std::memory_order_relaxed))
+        throw std::runtime_error("enqueue on stopped ThreadPool");
+
+    std::packaged_task<return_type()> task(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    std::future<return_type> res = task.get_future();
 
-    std::future<return_type> res = task->get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
+    submit(new HeapJob<std::packaged_task<return_type()>>(std::move(task)));
+    return res;
+}
 
-        if (stop)
-            throw std::runtime_error("enqueue on stopped ThreadPool");
+template<class A, class B>
+void ThreadPool::join(A&& a, B&& b) {
+    if (!onWorkerThread()) {
+        runOnWorker([&] { join(a, b); });
+        return;
+    }
 
-        tasks.emplace([task]() { (*task)(); });
+    StackJob<B> jobB(b);
+    if (!pushLocal(&jobB)) {
+        a();
+        b();
+        return;
     }
-    condition.notify_one();
-    return res;
+
+    try {
+        a();
+    } catch (...) {
+        // jobB references this frame, it must finish before unwinding
+        waitUntil(jobB.done);
+        throw;
+    }
+
+    waitUntil(jobB.done);
+    if (jobB.exception)
+        std::rethrow_exception(jobB.exception);
+}
+
+template<class F>
+void ThreadPool::parallelFor(int begin, int end, int grain, F&& body) {
+    if (begin >= end)
+        return;
+
+    grain = grain < 1 ? 1 : grain;
+    if (!onWorkerThread()) {
+        runOnWorker([&] { forRange(begin, end, grain, body); });
+        return;
+    }
+
+    forRange(begin, end, grain, body);
 }
+
+template<class F>
+void ThreadPool::forRange(int begin, int end, int grain, F& body) {
+    if (end - begin <= grain) {
+        for (int i = begin; i < end; ++i)
+            body(i);
+        return;
+    }
+
+    int middle = begin + (end - begin) / 2;
+    join([&] { forRange(begin, middle, grain, body); },
+         [&] { forRange(middle, end, grain, body); });
+}
+
+// Runs f on one of the workers and blocks the calling thread until it is done
+template<class F>
+void ThreadPool::runOnWorker(F&& f) {
+    BlockingJob<F> job(f);
+    submit(&job);
+    job.wait();
+
+    if (job.exception)
+        std::rethrow_exception(job.exception);
+}
+
+#endif // !THREADPOOL_H
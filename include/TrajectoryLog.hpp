@@ -0,0 +1,174 @@
+// Compact binary log of the plies played by the solver
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef TRAJECTORYLOG_H
+#define TRAJECTORYLOG_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Board.hpp"
+#include "MappedFile.hpp"
+
+// File layout, all integers little endian:
+//   header  "2048TRJ1", u32 version, u32 flags (bit 0: per-move scores stored)
+//   chunks  one per game: u32 plies, u32 reserved, u64 game id, then the grids
+//           (u64 each), the scores if stored (4 floats each), the packed bytes,
+//           zero padded to a multiple of 8 bytes
+//   index   u64 chunk offset, u32 plies, u32 reserved, u64 game id per game
+//   footer  u64 index offset, u64 number of games, "2048IDX1"
+// Grids come first in a chunk so that they stay 8-byte aligned and can be
+// viewed in place. A file whose footer is missing, because the writer did not
+// close it, is still read by walking the chunks from the header.
+//
+// A ply is the grid before the move, the move and the tile spawned after it,
+// packed in one byte: bits 0-1 move, bits 2-5 spawn cell, bit 6 set for a 4,
+// bit 7 set when a tile was spawned.
+constexpr char TRAJECTORY_MAGIC[8] = { '2', '0', '4', '8', 'T', 'R', 'J', '1' };
+constexpr char TRAJECTORY_INDEX_MAGIC[8] = { '2', '0', '4', '8', 'I', 'D', 'X', '1' };
+constexpr uint32_t TRAJECTORY_VERSION = 1;
+constexpr uint32_t TRAJECTORY_HAS_SCORES = 1;
+
+uint8_t packPly(Move move, int spawnCell, bool fourTile);
+// Recovers the spawn by comparing the slid grid with the grid of the next ply
+uint8_t packPly(Grid before, Move move, Grid after);
+
+struct Ply {
+    Grid grid;
+    uint8_t packed;
+    // Per-move scores of the search, null if the log does not store them
+    const float* scores;
+
+    Move move() const { return static_cast<Move>(packed & 0x3); }
+    bool spawned() const { return (packed & 0x80) != 0; }
+    int spawnCell() const { return (packed >> 2) & 0xF; }
+    // Exponent of the spawned tile, 1 for a 2 and 2 for a 4
+    int spawnTile() const { return (packed & 0x40) ? 2 : 1; }
+};
+
+// Plies of one game, buffered in memory until the game is written
+class GameTrajectory {
+public:
+    explicit GameTrajectory(uint64_t gameId = 0);
+
+    void append(Grid before, Move move, Grid after);
+    void append(Grid before, Move move, Grid after, const std::array<double, NUMBER_OF_MOVES>& scores);
+    void clear(uint64_t gameId);
+
+    uint64_t gameId() const;
+    size_t size() const;
+
+private:
+    friend class TrajectoryWriter;
+
+    uint64_t gameId_;
+    std::vector<Grid> grids_;
+    std::vector<uint8_t> packed_;
+    std::vector<float> scores_;
+};
+
+// Append-only writer, write() can be called from several threads at once
+class TrajectoryWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    explicit TrajectoryWriter(const std::string& path, bool withScores = false);
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+    ~TrajectoryWriter();
+
+    void write(const GameTrajectory& game);
+    // Writes the index and the footer, called by the destructor otherwise
+    void close();
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint32_t plies;
+        uint32_t reserved;
+        uint64_t gameId;
+    };
+
+    void writeBytes(const void* data, size_t size);
+
+    std::FILE* file_;
+    bool withScores_;
+    uint64_t offset_;
+    std::vector<IndexEntry> index_;
+    std::mutex mutex_;
+};
+
+// View on one game of a mapped log, valid as long as its reader
+class GameView {
+public:
+    class Iterator {
+    public:
+        Iterator(const GameView* game, size_t index) : game_(game), index_(index) {}
+        Ply operator*() const { return (*game_)[index_]; }
+        Iterator& operator++() { ++index_; return *this; }
+        bool operator!=(const Iterator& other) const { return index_ != other.index_; }
+
+    private:
+        const GameView* game_;
+        size_t index_;
+    };
+
+    GameView(uint64_t gameId, size_t plies, const Grid* grids, const uint8_t* packed, const float* scores);
+
+    uint64_t gameId() const;
+    size_t size() const;
+    Ply operator[](size_t index) const;
+    Iterator begin() const;
+    Iterator end() const;
+
+    // Raw arrays, scores holds NUMBER_OF_MOVES floats per ply or is null
+    const Grid* grids() const;
+    const uint8_t* packed() const;
+    const float* scores() const;
+
+private:
+    uint64_t gameId_;
+    size_t plies_;
+    const Grid* grids_;
+    const uint8_t* packed_;
+    const float* scores_;
+};
+
+// Maps a whole log read-only, nothing is copied
+class TrajectoryReader {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is corrupted
+    explicit TrajectoryReader(const std::string& path);
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    bool hasScores() const;
+    size_t numberOfGames() const;
+    size_t numberOfPlies() const;
+    GameView game(size_t index) const;
+
+private:
+    struct Chunk {
+        uint64_t offset;
+        size_t plies;
+        uint64_t gameId;
+    };
+
+    void readIndex();
+    void scanChunks();
+    size_t chunkSize(size_t plies) const;
+
+    MappedFile mapping_;
+    const unsigned char* data_;
+    size_t size_;
+    bool withScores_;
+    std::vector<Chunk> chunks_;
+};
+
+#endif // !TRAJECTORYLOG_H
@@ -0,0 +1,72 @@
+// Transposition table caching search results across moves
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Consts.hpp"
+#include "MoveTables.hpp"
+
+enum class Replacement { DEPTH_PREFERRED = 0, ALWAYS_REPLACE = 1 };
+
+struct TableEntry {
+    float value;
+    uint16_t depth;
+    // Standard deviation of the samples the value was averaged over, 0 for
+    // exact values. Kept to about three significant digits
+    float spread;
+};
+
+// Fixed-size table keyed by Grid, shared by the search engines and the pool's
+// workers without any lock. Every slot stores its key XORed with its data, so
+// a slot torn by two concurrent writers fails verification and is treated as a
+// miss instead of returning a mixed entry. Engines storing different kinds of
+// values in one table keep them apart by salting their keys.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t sizeInMegabytes = TRANSPOSITION_TABLE_SIZE_MB,
+        Replacement replacement = Replacement::DEPTH_PREFERRED);
+
+    bool probe(Grid key, TableEntry& entry);
+    void store(Grid key, float value, uint16_t depth, float spread = 0.0f);
+    void clear();
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+    void resetCounters();
+
+private:
+    static constexpr int SLOTS_PER_BUCKET = 4;
+    static constexpr int COUNTER_STRIPES = 16;
+
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot entries[SLOTS_PER_BUCKET];
+    };
+
+    // Spread over cache lines so that workers do not contend on one counter
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> hits;
+        std::atomic<uint64_t> misses;
+    };
+
+    size_t bucketIndex(Grid key) const;
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t numberOfBuckets_;
+    int indexShift_;
+    Replacement replacement_;
+    Counters counters_[COUNTER_STRIPES];
+};
+
+#endif // !TRANSPOSITIONTABLE_H
@@ -0,0 +1,138 @@
+// Bump allocators for search trees and scratch state
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "Arena.hpp"
+
+#include <algorithm>
+
+Arena::Arena(size_t chunkSize, size_t limit)
+    : current_(0), cursor_(nullptr), end_(nullptr), chunkSize_(std::max<size_t>(chunkSize, 64)), limit_(limit),
+      used_(0), highWaterMark_(0) {
+}
+
+Arena::~Arena() {
+    release();
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(cursor_);
+    size_t padding = (alignment - address % alignment) % alignment;
+    if (cursor_ == nullptr || padding + size > static_cast<size_t>(end_ - cursor_)) {
+        if (used_ + size > limit_ || !nextChunk(size, alignment)) {
+            return nullptr;
+        }
+        address = reinterpret_cast<uintptr_t>(cursor_);
+        padding = (alignment - address % alignment) % alignment;
+    }
+    if (used_ + padding + size > limit_) {
+        return nullptr;
+    }
+
+    void* memory = cursor_ + padding;
+    cursor_ += padding + size;
+    used_ += padding + size;
+    highWaterMark_ = std::max(highWaterMark_, used_);
+    return memory;
+}
+
+// Moves on to the next kept chunk large enough, or adds one. Chunks too small
+// for an oversized request are skipped, they are used again after a reset.
+bool Arena::nextChunk(size_t size, size_t alignment) {
+    size_t needed = size + alignment;
+    size_t next = cursor_ == nullptr ? 0 : current_ + 1;
+    while (next < chunks_.size() && chunks_[next].size < needed) {
+        ++next;
+    }
+    if (next == chunks_.size()) {
+        size_t chunkSize = std::max(chunkSize_, needed);
+        unsigned char* data = static_cast<unsigned char*>(::operator new(chunkSize, std::nothrow));
+        if (data == nullptr) {
+            return false;
+        }
+        chunks_.push_back(Chunk{ data, chunkSize });
+    }
+
+    current_ = next;
+    cursor_ = chunks_[next].data;
+    end_ = cursor_ + chunks_[next].size;
+    return true;
+}
+
+void Arena::reset() {
+    current_ = 0;
+    cursor_ = chunks_.empty() ? nullptr : chunks_[0].data;
+    end_ = chunks_.empty() ? nullptr : cursor_ + chunks_[0].size;
+    used_ = 0;
+}
+
+void Arena::release() {
+    for (Chunk& chunk : chunks_) {
+        ::operator delete(chunk.data);
+    }
+    chunks_.clear();
+    current_ = 0;
+    cursor_ = nullptr;
+    end_ = nullptr;
+    used_ = 0;
+}
+
+size_t Arena::bytesUsed() const {
+    return used_;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t reserved = 0;
+    for (const Chunk& chunk : chunks_) {
+        reserved += chunk.size;
+    }
+    return reserved;
+}
+
+size_t Arena::highWaterMark() const {
+    return highWaterMark_;
+}
+
+WorkerArenas::WorkerArenas(int numberOfWorkers, size_t chunkSize, size_t limitPerWorker) {
+    for (int worker = 0; worker < std::max(1, numberOfWorkers); ++worker) {
+        arenas_.push_back(std::make_unique<Arena>(chunkSize, limitPerWorker));
+    }
+}
+
+Arena& WorkerArenas::operator[](int worker) {
+    return *arenas_[worker];
+}
+
+int WorkerArenas::size() const {
+    return static_cast<int>(arenas_.size());
+}
+
+void WorkerArenas::reset() {
+    for (std::unique_ptr<Arena>& arena : arenas_) {
+        arena->reset();
+    }
+}
+
+size_t WorkerArenas::bytesUsed() const {
+    size_t used = 0;
+    for (const std::unique_ptr<Arena>& arena : arenas_) {
+        used += arena->bytesUsed();
+    }
+    return used;
+}
+
+size_t WorkerArenas::bytesReserved() const {
+    size_t reserved = 0;
+    for (const std::unique_ptr<Arena>& arena : arenas_) {
+        reserved += arena->bytesReserved();
+    }
+    return reserved;
+}
+
+size_t WorkerArenas::highWaterMark() const {
+    size_t highWaterMark = 0;
+    for (const std::unique_ptr<Arena>& arena : arenas_) {
+        highWaterMark += arena->highWaterMark();
+    }
+    return highWaterMark;
+}
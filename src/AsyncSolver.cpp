@@ -0,0 +1,177 @@
+// Searches on a background thread, answered through futures or callbacks
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "AsyncSolver.hpp"
+
+AsyncSolver::AsyncSolver(std::shared_ptr<Policy> policy, bool ponder, std::chrono::microseconds ponderBudget)
+    : policy_(std::move(policy)), ponder_(ponder), ponderBudget_(ponderBudget), thread_([this] { run(); }) {
+}
+
+AsyncSolver::~AsyncSolver() {
+    std::unique_ptr<Request> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+        pending = std::move(pending_);
+    }
+    wake_.notify_one();
+    thread_.join();
+
+    if (pending) {
+        deliverCancelled(*pending, false);
+    }
+}
+
+std::future<Decision> AsyncSolver::request(const Board& board, std::chrono::microseconds budget) {
+    std::promise<Decision> promise;
+    std::future<Decision> future = promise.get_future();
+    enqueue(board, budget, nullptr, std::move(promise));
+    return future;
+}
+
+uint64_t AsyncSolver::request(const Board& board, std::chrono::microseconds budget, Callback callback) {
+    return enqueue(board, budget, std::move(callback), std::promise<Decision>());
+}
+
+uint64_t AsyncSolver::enqueue(const Board& board, std::chrono::microseconds budget, Callback callback, std::promise<Decision> promise) {
+    std::unique_ptr<Request> replaced;
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        replaced = std::move(pending_);
+        pending_.reset(new Request{ id, board, budget, std::move(callback), std::move(promise) });
+    }
+    wake_.notify_one();
+
+    if (replaced) {
+        deliverCancelled(*replaced, true);
+    }
+    return id;
+}
+
+void AsyncSolver::cancel() {
+    std::unique_ptr<Request> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelledUpTo_ = nextId_ - 1;
+        cancelled = std::move(pending_);
+        ponderPositions_.clear();
+    }
+
+    if (cancelled) {
+        deliverCancelled(*cancelled, true);
+    }
+}
+
+void AsyncSolver::newGame() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        newGame_ = true;
+        ponderPositions_.clear();
+    }
+    wake_.notify_one();
+}
+
+uint64_t AsyncSolver::positionsPondered() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return positionsPondered_;
+}
+
+void AsyncSolver::deliver(Request& request, const Decision& decision, bool callBack) {
+    if (callBack && request.callback) {
+        request.callback(decision);
+    }
+    request.promise.set_value(decision);
+}
+
+void AsyncSolver::deliverCancelled(Request& request, bool callBack) {
+    Decision decision;
+    decision.request = request.id;
+    decision.board = request.board;
+    decision.cancelled = true;
+    deliver(request, decision, callBack);
+}
+
+Decision AsyncSolver::search(const Request& request) {
+    auto start = std::chrono::steady_clock::now();
+    Decision decision;
+    decision.request = request.id;
+    decision.board = request.board;
+    decision.move = request.budget.count() > 0 ? policy_->bestMove(request.board, request.budget)
+                                               : policy_->bestMove(request.board);
+    decision.hasValues = policy_->lastValues(decision.values);
+    decision.searched = true;
+    decision.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return decision;
+}
+
+// Every 2 before any 4, a 2 being nine times as likely
+void AsyncSolver::queuePonderPositions(const Board& board, Move move) {
+    ponderPositions_.clear();
+    Board afterstate = board;
+    if (!applyMove(afterstate, move)) {
+        return;
+    }
+
+    for (Grid tile : { Grid(1), Grid(2) }) {
+        for (int cell = 0; cell < GRID_SIZE * GRID_SIZE; ++cell) {
+            if (((afterstate.grid >> (cell * 4)) & 0xF) != 0) {
+                continue;
+            }
+            Board next = afterstate;
+            next.grid |= tile << (cell * 4);
+            if (!isGameOver(next.grid)) {
+                ponderPositions_.push_back(next);
+            }
+        }
+    }
+}
+
+// Requests go before pondering and a new game before both. The lock is
+// released while the policy searches
+void AsyncSolver::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [this] {
+            return stop_ || newGame_ || pending_ || !ponderPositions_.empty();
+        });
+        if (stop_) {
+            return;
+        }
+
+        if (newGame_) {
+            newGame_ = false;
+            lock.unlock();
+            policy_->newGame();
+            lock.lock();
+            continue;
+        }
+
+        if (pending_) {
+            std::unique_ptr<Request> request = std::move(pending_);
+            lock.unlock();
+            Decision decision = search(*request);
+            lock.lock();
+
+            decision.cancelled = request->id <= cancelledUpTo_;
+            if (ponder_ && !decision.cancelled && !newGame_) {
+                queuePonderPositions(request->board, decision.move);
+            }
+            // The owner of the callback may be going away with the solver
+            bool callBack = !stop_;
+            lock.unlock();
+            deliver(*request, decision, callBack);
+            lock.lock();
+            continue;
+        }
+
+        Board board = ponderPositions_.front();
+        ponderPositions_.pop_front();
+        lock.unlock();
+        policy_->ponder(board, ponderBudget_);
+        lock.lock();
+        ++positionsPondered_;
+    }
+}
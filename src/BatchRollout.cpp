@@ -0,0 +1,276 @@
+// Rollouts played on several boards in lockstep with SIMD move kernels
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "BatchRollout.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BATCH_ROLLOUT_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Every kernel slides each lane's grid in the direction held by two bits of
+// moveBits (lane i reads bits 2i and 2i + 1) and returns the moved grids with
+// the score gained by the merges. Illegal moves leave the grid unchanged.
+struct PortableKernel {
+    static constexpr int LANES = 8;
+
+    static void step(const Grid* grids, uint64_t moveBits, Grid* moved, uint64_t* gained) {
+        for (int lane = 0; lane < LANES; ++lane) {
+            uint32_t score = 0;
+            moved[lane] = moveGrid(grids[lane], static_cast<Move>((moveBits >> (2 * lane)) & 3), score);
+            gained[lane] = score;
+        }
+    }
+};
+
+#ifdef BATCH_ROLLOUT_X86
+
+// The grids are transposed for vertical moves, each row is then looked up in
+// the packed table at row + 65536 for right moves, and vertical results are
+// transposed back. Lanes go through the same instructions whatever their move.
+struct Avx2Kernel {
+    static constexpr int LANES = 8;
+
+    __attribute__((target("avx2")))
+    static __m256i transpose(__m256i grid) {
+        const __m256i a1 = _mm256_and_si256(grid, _mm256_set1_epi64x(static_cast<int64_t>(0xF0F00F0FF0F00F0FULL)));
+        const __m256i a2 = _mm256_and_si256(grid, _mm256_set1_epi64x(0x0000F0F00000F0F0LL));
+        const __m256i a3 = _mm256_and_si256(grid, _mm256_set1_epi64x(0x0F0F00000F0F0000LL));
+        const __m256i a = _mm256_or_si256(a1, _mm256_or_si256(_mm256_slli_epi64(a2, 12), _mm256_srli_epi64(a3, 12)));
+        const __m256i b1 = _mm256_and_si256(a, _mm256_set1_epi64x(static_cast<int64_t>(0xFF00FF0000FF00FFULL)));
+        const __m256i b2 = _mm256_and_si256(a, _mm256_set1_epi64x(0x00FF00FF00000000LL));
+        const __m256i b3 = _mm256_and_si256(a, _mm256_set1_epi64x(0x00000000FF00FF00LL));
+        return _mm256_or_si256(b1, _mm256_or_si256(_mm256_srli_epi64(b2, 24), _mm256_slli_epi64(b3, 24)));
+    }
+
+    __attribute__((target("avx2")))
+    static void step(const Grid* grids, uint64_t moveBits, Grid* moved, uint64_t* gained) {
+        const int* table = reinterpret_cast<const int*>(moveTables().packed);
+        const __m256i rowMask = _mm256_set1_epi64x(static_cast<int64_t>(ROW_MASK));
+        const __m256i one = _mm256_set1_epi64x(1);
+        const __m256i two = _mm256_set1_epi64x(2);
+
+        for (int half = 0; half < LANES; half += 4) {
+            uint64_t bits = moveBits >> (2 * half);
+            const __m256i moves = _mm256_set_epi64x((bits >> 6) & 3, (bits >> 4) & 3, (bits >> 2) & 3, bits & 3);
+            const __m256i vertical = _mm256_cmpeq_epi64(_mm256_and_si256(moves, two), two);
+            const __m256i rightOffset = _mm256_slli_epi64(_mm256_and_si256(moves, one), ROW_BITS);
+
+            const __m256i grid = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(grids + half));
+            const __m256i oriented = _mm256_blendv_epi8(grid, transpose(grid), vertical);
+
+            __m256i result = _mm256_setzero_si256();
+            __m256i score = _mm256_setzero_si256();
+            for (int row = 0; row < GRID_SIZE; ++row) {
+                const __m256i shift = _mm256_set1_epi64x(row * ROW_BITS);
+                const __m256i index = _mm256_or_si256(_mm256_and_si256(_mm256_srlv_epi64(oriented, shift), rowMask), rightOffset);
+                const __m256i entry = _mm256_cvtepu32_epi64(_mm256_i64gather_epi32(table, index, 4));
+                result = _mm256_or_si256(result, _mm256_sllv_epi64(_mm256_and_si256(entry, rowMask), shift));
+                score = _mm256_add_epi64(score, _mm256_srli_epi64(entry, ROW_BITS));
+            }
+
+            result = _mm256_blendv_epi8(result, transpose(result), vertical);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(moved + half), result);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(gained + half), _mm256_slli_epi64(score, 2));
+        }
+    }
+};
+
+// GCC 12 warns about the undefined vectors the AVX-512 intrinsics pass to
+// their unmasked builtins, which are never read
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+struct Avx512Kernel {
+    static constexpr int LANES = 16;
+
+    __attribute__((target("avx512f")))
+    static __m512i transpose(__m512i grid) {
+        const __m512i a1 = _mm512_and_si512(grid, _mm512_set1_epi64(static_cast<int64_t>(0xF0F00F0FF0F00F0FULL)));
+        const __m512i a2 = _mm512_and_si512(grid, _mm512_set1_epi64(0x0000F0F00000F0F0LL));
+        const __m512i a3 = _mm512_and_si512(grid, _mm512_set1_epi64(0x0F0F00000F0F0000LL));
+        const __m512i a = _mm512_or_si512(a1, _mm512_or_si512(_mm512_slli_epi64(a2, 12), _mm512_srli_epi64(a3, 12)));
+        const __m512i b1 = _mm512_and_si512(a, _mm512_set1_epi64(static_cast<int64_t>(0xFF00FF0000FF00FFULL)));
+        const __m512i b2 = _mm512_and_si512(a, _mm512_set1_epi64(0x00FF00FF00000000LL));
+        const __m512i b3 = _mm512_and_si512(a, _mm512_set1_epi64(0x00000000FF00FF00LL));
+        return _mm512_or_si512(b1, _mm512_or_si512(_mm512_srli_epi64(b2, 24), _mm512_slli_epi64(b3, 24)));
+    }
+
+    __attribute__((target("avx512f")))
+    static void step(const Grid* grids, uint64_t moveBits, Grid* moved, uint64_t* gained) {
+        const int* table = reinterpret_cast<const int*>(moveTables().packed);
+        const __m512i rowMask = _mm512_set1_epi64(static_cast<int64_t>(ROW_MASK));
+        const __m512i rightRows = _mm512_set1_epi64(NUMBER_OF_ROWS);
+
+        for (int half = 0; half < LANES; half += 8) {
+            __mmask8 vertical = 0;
+            __mmask8 right = 0;
+            for (int lane = 0; lane < 8; ++lane) {
+                uint64_t move = (moveBits >> (2 * (half + lane))) & 3;
+                vertical |= static_cast<__mmask8>((move >> 1) << lane);
+                right |= static_cast<__mmask8>((move & 1) << lane);
+            }
+            const __m512i rightOffset = _mm512_maskz_mov_epi64(right, rightRows);
+
+            const __m512i grid = _mm512_loadu_si512(grids + half);
+            const __m512i oriented = _mm512_mask_blend_epi64(vertical, grid, transpose(grid));
+
+            __m512i result = _mm512_setzero_si512();
+            __m512i score = _mm512_setzero_si512();
+            for (int row = 0; row < GRID_SIZE; ++row) {
+                const __m512i shift = _mm512_set1_epi64(row * ROW_BITS);
+                const __m512i index = _mm512_or_si512(_mm512_and_si512(_mm512_srlv_epi64(oriented, shift), rowMask), rightOffset);
+                const __m512i entry = _mm512_cvtepu32_epi64(_mm512_i64gather_epi32(index, table, 4));
+                result = _mm512_or_si512(result, _mm512_sllv_epi64(_mm512_and_si512(entry, rowMask), shift));
+                score = _mm512_add_epi64(score, _mm512_srli_epi64(entry, ROW_BITS));
+            }
+
+            result = _mm512_mask_blend_epi64(vertical, result, transpose(result));
+            _mm512_storeu_si512(moved + half, result);
+            _mm512_storeu_si512(gained + half, _mm512_slli_epi64(score, 2));
+        }
+    }
+};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // BATCH_ROLLOUT_X86
+
+// A lane stops once its game is over or it has played DEPTH moves, exactly
+// like simulate(). Legal moves spawn a tile, which is done lane by lane since
+// only the lanes that moved need one.
+template<class Kernel>
+RolloutStats runLanes(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen) {
+    constexpr int LANES = Kernel::LANES;
+    static_assert(2 * LANES <= 64, "one draw must give every lane its move");
+
+    alignas(64) Grid grids[LANES] = {};
+    alignas(64) Grid moved[LANES];
+    alignas(64) uint64_t gained[LANES];
+    int scores[LANES] = {};
+    int steps[LANES] = {};
+    bool active[LANES] = {};
+
+    RolloutStats stats;
+    int started = 0;
+    int running = 0;
+
+    auto startRollout = [&](int lane) {
+        if (started == numberOfSimulations) {
+            active[lane] = false;
+            grids[lane] = 0;
+            --running;
+            return;
+        }
+        Board start = move(board, currentMove, gen);
+        grids[lane] = start.grid;
+        scores[lane] = start.score;
+        steps[lane] = 0;
+        ++started;
+    };
+
+    for (int lane = 0; lane < LANES; ++lane) {
+        active[lane] = true;
+        ++running;
+        startRollout(lane);
+    }
+
+    while (running > 0) {
+        Kernel::step(grids, gen(), moved, gained);
+
+        for (int lane = 0; lane < LANES; ++lane) {
+            if (!active[lane]) {
+                continue;
+            }
+
+            bool finished;
+            if (moved[lane] != grids[lane]) {
+                Board next{ moved[lane], scores[lane] + static_cast<int>(gained[lane]) };
+                addRandomTile(next, gen);
+                grids[lane] = next.grid;
+                scores[lane] = next.score;
+                ++stats.moves;
+                finished = ++steps[lane] >= DEPTH;
+            } else {
+                finished = ++steps[lane] >= DEPTH || isGameOver(grids[lane]);
+            }
+
+            if (finished) {
+                double score = scores[lane];
+                stats.total += score;
+                stats.totalSquares += score * score;
+                ++stats.count;
+                startRollout(lane);
+            }
+        }
+    }
+
+    return stats;
+}
+
+} // namespace
+
+bool batchIsaSupported(BatchIsa isa) {
+    switch (isa) {
+    case BatchIsa::PORTABLE:
+        return true;
+#ifdef BATCH_ROLLOUT_X86
+    case BatchIsa::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case BatchIsa::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+BatchIsa bestBatchIsa() {
+    static const BatchIsa best = batchIsaSupported(BatchIsa::AVX512) ? BatchIsa::AVX512
+        : batchIsaSupported(BatchIsa::AVX2) ? BatchIsa::AVX2
+        : BatchIsa::PORTABLE;
+    return best;
+}
+
+int batchLanes(BatchIsa isa) {
+#ifdef BATCH_ROLLOUT_X86
+    if (isa == BatchIsa::AVX2) {
+        return Avx2Kernel::LANES;
+    }
+    if (isa == BatchIsa::AVX512) {
+        return Avx512Kernel::LANES;
+    }
+#endif
+    return PortableKernel::LANES;
+}
+
+RolloutStats runSimulationsBatched(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen) {
+    return runSimulationsBatched(board, currentMove, numberOfSimulations, gen, bestBatchIsa());
+}
+
+RolloutStats runSimulationsBatched(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen, BatchIsa isa) {
+    // Too few rollouts to fill half the lanes, the lockstep loop would mostly
+    // slide empty lanes
+    if (2 * numberOfSimulations < batchLanes(isa)) {
+        return runSimulations(board, currentMove, numberOfSimulations, gen);
+    }
+
+    // Unsupported kernels fall back to the portable one
+#ifdef BATCH_ROLLOUT_X86
+    if (isa == BatchIsa::AVX512 && batchIsaSupported(isa)) {
+        return runLanes<Avx512Kernel>(board, currentMove, numberOfSimulations, gen);
+    }
+    if (isa == BatchIsa::AVX2 && batchIsaSupported(isa)) {
+        return runLanes<Avx2Kernel>(board, currentMove, numberOfSimulations, gen);
+    }
+#endif
+    return runLanes<PortableKernel>(board, currentMove, numberOfSimulations, gen);
+}
@@ -0,0 +1,23 @@
+// Lightweight board used by the solver, independent from Qt
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <bitset>
+
+#include "Board.hpp"
+
+bool reached2048(Grid grid) {
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; ++i) {
+        int tile = (grid >> (i * 4)) & 0xF;
+        if (tile == 11) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::ostream& operator<<(std::ostream& os, const Board& board) {
+    std::bitset<64> binary(board.grid);
+    os << binary;
+    return os;
+}
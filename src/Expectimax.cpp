@@ -0,0 +1,130 @@
+// Expectimax search to compute the best move at each state
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <algorithm>
+#include <limits>
+
+#include "Expectimax.hpp"
+
+constexpr double ILLEGAL_MOVE_VALUE = -std::numeric_limits<double>::infinity();
+
+Expectimax::Expectimax(ExpectimaxOptions options, TranspositionTable* table, const Evaluator* evaluator)
+    : options_(options), table_(table), evaluator_(evaluator), timed_(false), aborted_(false), nodes_(0) {
+}
+
+Move Expectimax::bestMove(const Board& board) {
+    std::array<double, NUMBER_OF_MOVES> values = evaluateMoves(board.grid);
+
+    auto bestMoveIter = std::max_element(values.begin(), values.end());
+    int bestMoveIndex = std::distance(values.begin(), bestMoveIter);
+
+    return static_cast<Move>(bestMoveIndex);
+}
+
+Move Expectimax::bestMove(const Board& board, std::chrono::microseconds budget) {
+    timed_ = true;
+    aborted_ = false;
+    nodes_ = 0;
+    deadline_ = std::chrono::steady_clock::now() + budget;
+
+    std::array<double, NUMBER_OF_MOVES> values = evaluateMoves(board.grid, 1);
+    for (int depth = 2; depth <= options_.maxDepth; ++depth) {
+        std::array<double, NUMBER_OF_MOVES> deeperValues = evaluateMoves(board.grid, depth);
+        if (aborted_) {
+            break;
+        }
+        values = deeperValues;
+    }
+
+    timed_ = false;
+    aborted_ = false;
+
+    auto bestMoveIter = std::max_element(values.begin(), values.end());
+    int bestMoveIndex = std::distance(values.begin(), bestMoveIter);
+
+    return static_cast<Move>(bestMoveIndex);
+}
+
+std::array<double, NUMBER_OF_MOVES> Expectimax::evaluateMoves(Grid grid) {
+    return evaluateMoves(grid, options_.depth);
+}
+
+std::array<double, NUMBER_OF_MOVES> Expectimax::evaluateMoves(Grid grid, int depth) {
+    std::array<double, NUMBER_OF_MOVES> values;
+
+    for (int i = 0; i < NUMBER_OF_MOVES; ++i) {
+        uint32_t gainedScore = 0;
+        Grid movedGrid = moveGrid(grid, static_cast<Move>(i), gainedScore);
+
+        if (movedGrid == grid) {
+            values[i] = ILLEGAL_MOVE_VALUE;
+        } else {
+            values[i] = gainedScore + chanceNode(movedGrid, depth - 1, 1.0);
+        }
+    }
+
+    return values;
+}
+
+// Reads the clock every few thousand nodes only
+bool Expectimax::outOfTime() {
+    if (!aborted_ && timed_ && (++nodes_ & 0xFFF) == 0 && std::chrono::steady_clock::now() >= deadline_) {
+        aborted_ = true;
+    }
+    return aborted_;
+}
+
+double Expectimax::maxNode(Grid grid, int depth, double probability) {
+    if (outOfTime()) {
+        return 0.0;
+    }
+
+    // A lost position gains nothing more
+    double best = ILLEGAL_MOVE_VALUE;
+
+    for (int i = 0; i < NUMBER_OF_MOVES; ++i) {
+        uint32_t gainedScore = 0;
+        Grid movedGrid = moveGrid(grid, static_cast<Move>(i), gainedScore);
+
+        if (movedGrid != grid) {
+            best = std::max(best, gainedScore + chanceNode(movedGrid, depth - 1, probability));
+        }
+    }
+
+    return best == ILLEGAL_MOVE_VALUE ? 0.0 : best;
+}
+
+double Expectimax::chanceNode(Grid grid, int depth, double probability) {
+    if (depth <= 0 || probability < options_.probabilityCutoff) {
+        return evaluator_ != nullptr ? evaluator_->evaluate(grid) : 0.0;
+    }
+
+    Grid key = options_.canonicalKeys ? canonicalKey(grid) : grid;
+    TableEntry entry;
+    if (table_ != nullptr && table_->probe(key, entry) && entry.depth >= depth) {
+        return entry.value;
+    }
+
+    Grid emptyMask = emptyCellMask(grid);
+    int emptyCells = __builtin_popcountll(emptyMask);
+    double twoProbability = probability * (1.0 - FOUR_TILE_PROBABILITY) / emptyCells;
+    double fourProbability = probability * FOUR_TILE_PROBABILITY / emptyCells;
+
+    double expectedValue = 0.0;
+    while (emptyMask != 0) {
+        int shift = __builtin_ctzll(emptyMask);
+        emptyMask &= emptyMask - 1;
+
+        expectedValue += (1.0 - FOUR_TILE_PROBABILITY) * maxNode(grid | (1ULL << shift), depth, twoProbability);
+        expectedValue += FOUR_TILE_PROBABILITY * maxNode(grid | (2ULL << shift), depth, fourProbability);
+    }
+
+    expectedValue /= emptyCells;
+    // A value computed after the deadline is incomplete and must not be cached
+    if (table_ != nullptr && !aborted_) {
+        table_->store(key, static_cast<float>(expectedValue), static_cast<uint16_t>(depth));
+    }
+
+    return expectedValue;
+}
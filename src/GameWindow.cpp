@@ -4,8 +4,12 @@
 
 #include "GameWindow.hpp"
 
-GameWindow::GameWindow(QWidget* parent, std::shared_ptr<Game> game, bool autoplay)
-    : QWidget(parent), game_(game), gridLabels(std::vector<std::vector<QLabel*>>(GRID_SIZE)) {
+GameWindow::GameWindow(QWidget* parent, std::shared_ptr<Game> game, std::shared_ptr<Policy> policy, bool autoplay, bool ponder)
+    : QWidget(parent), game_(game), gridLabels(std::vector<std::vector<QLabel*>>(GRID_SIZE)),
+      solver_(std::make_unique<AsyncSolver>(policy, ponder)) {
+
+    qRegisterMetaType<Decision>();
+    connect(this, &GameWindow::decisionReady, this, &GameWindow::playDecision, Qt::QueuedConnection);
 
     for (std::vector<QLabel*>& row : gridLabels) {
         row.resize(GRID_SIZE);
@@ -43,6 +47,7 @@ void GameWindow::updateGrid() {
 
     if (game_->isGameOver()) {
         game_ = std::make_shared<Game>();
+        solver_->newGame();
         updateGrid();
     }
 }
@@ -53,32 +58,55 @@ void GameWindow::startAutoPlay() {
     timer->start(DELAY);
 }
 
+// A tick arriving while the previous search runs is skipped, the timer only
+// paces the moves
 void GameWindow::autoPlayMove() {
-    Move bestMove;
+    if (awaitedRequest_ != 0) {
+        return;
+    }
 
-    bestMove = performMC(
-        *(game_.get()),
-        NUMBER_OF_SIMULATIONS_PER_MOVE,
-        std::thread::hardware_concurrency()
-    );
+    // Stays within the timer tick whatever the board and the core count
+    requestMove(std::chrono::microseconds(MOVE_TIME_BUDGET_US));
+}
 
-    emit keyPressed(SPACEBAR_CHAR, bestMove, game_);
-    updateGrid();
+void GameWindow::requestMove(std::chrono::microseconds budget) {
+    awaitedRequest_ = solver_->request(game_->getBoard(), budget, [this](const Decision& decision) {
+        emit decisionReady(decision);
+    });
 }
 
+// Runs on the GUI thread. Decisions of replaced requests, and decisions for a
+// position the player has moved away from, are dropped
+void GameWindow::playDecision(const Decision& decision) {
+    if (decision.request != awaitedRequest_) {
+        return;
+    }
+    awaitedRequest_ = 0;
 
-void GameWindow::keyPressEvent(QKeyEvent* event) {
-    Move bestMove;
+    if (decision.cancelled || decision.board.grid != game_->getGrid()) {
+        return;
+    }
 
+    emit keyPressed(SPACEBAR_CHAR, decision.move, game_);
+    updateGrid();
+}
+
+void GameWindow::keyPressEvent(QKeyEvent* event) {
+    // The space bar asks for a full search, played once it completes
     if (event->key() == SPACEBAR_CHAR) {
-        bestMove = performMC(
-            *(game_.get()),
-            NUMBER_OF_SIMULATIONS_PER_MOVE,
-            std::thread::hardware_concurrency()
-        );
+        requestMove(std::chrono::microseconds(0));
+        QWidget::keyPressEvent(event);
+        return;
     }
 
-    emit keyPressed(event->key(), bestMove, game_);
+    Grid before = game_->getGrid();
+    emit keyPressed(event->key(), Move::LEFT, game_);
+
+    // A move played by hand makes the search in flight stale
+    if (game_->getGrid() != before) {
+        solver_->cancel();
+        awaitedRequest_ = 0;
+    }
 
     QWidget::keyPressEvent(event);
     updateGrid();
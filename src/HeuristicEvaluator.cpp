@@ -0,0 +1,108 @@
+// Hand-tuned board heuristics precomputed per row
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "HeuristicEvaluator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+HeuristicEvaluator::HeuristicEvaluator(HeuristicWeights weights)
+    : weights_(weights), innerLines_(NUMBER_OF_ROWS), borderLines_(NUMBER_OF_ROWS) {
+    buildTables();
+}
+
+void HeuristicEvaluator::buildTables() {
+    for (int index = 0; index < NUMBER_OF_ROWS; ++index) {
+        int rank[GRID_SIZE];
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            rank[col] = (index >> (col * 4)) & 0xF;
+        }
+
+        double sum = 0.0;
+        int empty = 0;
+        int merges = 0;
+        int maxRank = 0;
+        int previous = 0;
+        int counter = 0;
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            sum += std::pow(rank[col], weights_.sumPower);
+            maxRank = std::max(maxRank, rank[col]);
+            if (rank[col] == 0) {
+                ++empty;
+                continue;
+            }
+
+            // A run of k equal tiles adds k
+            if (previous == rank[col]) {
+                ++counter;
+            } else if (counter > 0) {
+                merges += 1 + counter;
+                counter = 0;
+            }
+            previous = rank[col];
+        }
+        if (counter > 0) {
+            merges += 1 + counter;
+        }
+
+        double increasing = 0.0;
+        double decreasing = 0.0;
+        int smoothness = 0;
+        int lastTile = -1;
+        for (int col = 1; col < GRID_SIZE; ++col) {
+            double left = std::pow(rank[col - 1], weights_.monotonicityPower);
+            double right = std::pow(rank[col], weights_.monotonicityPower);
+            if (rank[col - 1] > rank[col]) {
+                decreasing += left - right;
+            } else {
+                increasing += right - left;
+            }
+        }
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            if (rank[col] == 0) {
+                continue;
+            }
+            if (lastTile >= 0) {
+                smoothness += std::abs(rank[col] - rank[lastTile]);
+            }
+            lastTile = col;
+        }
+
+        double value = weights_.alive
+            + weights_.emptyCells * empty
+            + weights_.merges * merges
+            - weights_.monotonicity * std::min(increasing, decreasing)
+            - weights_.smoothness * smoothness
+            - weights_.sum * sum;
+        bool maxAtEnd = maxRank > 0 && (rank[0] == maxRank || rank[GRID_SIZE - 1] == maxRank);
+
+        innerLines_[index] = static_cast<float>(value);
+        borderLines_[index] = static_cast<float>(value + (maxAtEnd ? weights_.corner * maxRank : 0.0));
+    }
+}
+
+double HeuristicEvaluator::evaluate(Grid grid) const {
+    Grid transposed = transposeGrid(grid);
+    const float* inner = innerLines_.data();
+    const float* border = borderLines_.data();
+
+    return border[grid & ROW_MASK]
+        + inner[(grid >> 16) & ROW_MASK]
+        + inner[(grid >> 32) & ROW_MASK]
+        + border[grid >> 48]
+        + border[transposed & ROW_MASK]
+        + inner[(transposed >> 16) & ROW_MASK]
+        + inner[(transposed >> 32) & ROW_MASK]
+        + border[transposed >> 48];
+}
+
+const HeuristicWeights& HeuristicEvaluator::weights() const {
+    return weights_;
+}
+
+void HeuristicEvaluator::setWeights(const HeuristicWeights& weights) {
+    weights_ = weights;
+    buildTables();
+}
@@ -0,0 +1,57 @@
+// Read-only memory mapping of a whole file
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path, bool copyOnWrite)
+    : data_(nullptr), size_(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw std::runtime_error("cannot stat " + path);
+    }
+
+    // An empty file cannot be mapped, it is seen as an empty range
+    size_ = static_cast<size_t>(status.st_size);
+    if (size_ > 0) {
+        int protection = copyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* mapping = ::mmap(nullptr, size_, protection, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("cannot map " + path);
+        }
+        data_ = static_cast<unsigned char*>(mapping);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        ::munmap(data_, size_);
+    }
+}
+
+const unsigned char* MappedFile::data() const {
+    return data_;
+}
+
+unsigned char* MappedFile::mutableData() {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
@@ -0,0 +1,433 @@
+// Monte Carlo tree search with chance nodes for the tile spawns
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "Mcts.hpp"
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+static void addValue(std::atomic<double>& total, double value) {
+    double current = total.load(std::memory_order_relaxed);
+    while (!total.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
+
+// Null when the arena is over its limit
+static MctsNode* makeNode(Arena& arena, Grid grid, uint32_t reward, int move) {
+    MctsNode* node = arena.make<MctsNode>();
+    if (node == nullptr) {
+        return nullptr;
+    }
+    node->grid = grid;
+    node->total.store(0.0, std::memory_order_relaxed);
+    node->firstChild.store(nullptr, std::memory_order_relaxed);
+    node->nextSibling = nullptr;
+    node->visits.store(0, std::memory_order_relaxed);
+    node->reward = reward;
+    node->move = static_cast<uint8_t>(move);
+    return node;
+}
+
+Mcts::Tree::Tree(int numberOfWorkers, size_t limitPerWorker)
+    : generations{ WorkerArenas(numberOfWorkers, ARENA_CHUNK_SIZE, limitPerWorker),
+          WorkerArenas(numberOfWorkers, ARENA_CHUNK_SIZE, limitPerWorker) },
+      active(0), root(nullptr) {
+}
+
+Mcts::Mcts(MctsOptions options)
+    : options_(options), pool_(std::max(1, options.numThreads)) {
+    options_.numThreads = std::max(1, options_.numThreads);
+    options_.virtualLoss = std::max(0, options_.virtualLoss);
+    bool rootParallel = options_.parallelism == MctsParallelism::ROOT;
+    int numberOfTrees = rootParallel ? options_.numThreads : 1;
+    int workersPerTree = rootParallel ? 1 : options_.numThreads;
+    size_t nodesPerWorker = std::max<size_t>(2, options_.maxNodes / (numberOfTrees * workersPerTree));
+    for (int t = 0; t < numberOfTrees; ++t) {
+        trees_.push_back(std::make_unique<Tree>(workersPerTree, nodesPerWorker * sizeof(MctsNode)));
+    }
+    paths_.resize(options_.numThreads);
+    reseed(options_.seed);
+}
+
+Move Mcts::bestMove(const Board& board) {
+    return search(board).move;
+}
+
+Move Mcts::bestMove(const Board& board, std::chrono::microseconds budget) {
+    return search(board, budget).move;
+}
+
+MctsResult Mcts::search(const Board& board) {
+    return run(board, false, std::chrono::steady_clock::time_point());
+}
+
+MctsResult Mcts::search(const Board& board, std::chrono::microseconds budget) {
+    return run(board, true, std::chrono::steady_clock::now() + budget);
+}
+
+void Mcts::newGame() {
+    for (std::unique_ptr<Tree>& tree : trees_) {
+        tree->generations[0].reset();
+        tree->generations[1].reset();
+        tree->root = nullptr;
+    }
+}
+
+void Mcts::reseed(uint64_t seed) {
+    generators_.clear();
+    for (int t = 0; t < options_.numThreads; ++t) {
+        generators_.emplace_back(deriveSeed(seed, static_cast<uint64_t>(t)));
+    }
+}
+
+const MctsOptions& Mcts::options() const {
+    return options_;
+}
+
+uint64_t Mcts::playoutsPlayed() const {
+    return playoutsPlayed_;
+}
+
+size_t Mcts::bytesUsed() const {
+    size_t used = 0;
+    for (const std::unique_ptr<Tree>& tree : trees_) {
+        used += tree->generations[tree->active].bytesUsed();
+    }
+    return used;
+}
+
+size_t Mcts::bytesReserved() const {
+    size_t reserved = 0;
+    for (const std::unique_ptr<Tree>& tree : trees_) {
+        reserved += tree->generations[0].bytesReserved() + tree->generations[1].bytesReserved();
+    }
+    return reserved;
+}
+
+size_t Mcts::highWaterMark() const {
+    size_t highWaterMark = 0;
+    for (const std::unique_ptr<Tree>& tree : trees_) {
+        highWaterMark += std::max(tree->generations[0].highWaterMark(), tree->generations[1].highWaterMark());
+    }
+    return highWaterMark;
+}
+
+// The position searched is looked for among the grandchildren of the previous
+// root, that is after any move and spawn. When found its subtree is copied into
+// the idle generation, starting with the arena of the worker copying and
+// filling the others after it, then the old one is reset, which frees
+// everything else at once. Should the arenas fill up, the
+// subtree is copied in part: a decision node keeps all of its moves or none,
+// a chance node the spawns copied so far, and the nodes left out are grown
+// again.
+void Mcts::prepareRoot(Tree& tree, Grid grid) {
+    MctsNode* reached = nullptr;
+    if (options_.reuseTree && tree.root != nullptr) {
+        if (tree.root->grid == grid) {
+            return;
+        }
+        for (MctsNode* chance = tree.root->firstChild.load(std::memory_order_acquire); chance != nullptr && reached == nullptr;
+             chance = chance->nextSibling) {
+            for (MctsNode* child = chance->firstChild.load(std::memory_order_acquire); child != nullptr; child = child->nextSibling) {
+                if (child->grid == grid) {
+                    reached = child;
+                    break;
+                }
+            }
+        }
+    }
+
+    WorkerArenas& target = tree.generations[1 - tree.active];
+    target.reset();
+    int arenas = target.size();
+    int first = arenas > 1 ? std::max(0, pool_.currentWorker()) % arenas : 0;
+    int filled = 0;
+    auto allocate = [&](Grid nodeGrid, uint32_t reward, int move) {
+        for (; filled < arenas; ++filled) {
+            MctsNode* node = makeNode(target[(first + filled) % arenas], nodeGrid, reward, move);
+            if (node != nullptr) {
+                return node;
+            }
+        }
+        return static_cast<MctsNode*>(nullptr);
+    };
+
+    if (reached == nullptr) {
+        tree.root = allocate(grid, 0, 0);
+    } else {
+        // Sources with their copies, and whether they are decision nodes
+        std::vector<std::tuple<const MctsNode*, MctsNode*, bool>> stack;
+        std::vector<MctsNode*> children;
+        MctsNode* root = allocate(reached->grid, reached->reward, reached->move);
+        stack.emplace_back(reached, root, true);
+        while (!stack.empty()) {
+            const MctsNode* source = std::get<0>(stack.back());
+            MctsNode* copy = std::get<1>(stack.back());
+            bool decision = std::get<2>(stack.back());
+            stack.pop_back();
+            copy->visits.store(source->visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            copy->total.store(source->total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+            children.clear();
+            bool complete = true;
+            for (MctsNode* child = source->firstChild.load(std::memory_order_acquire); child != nullptr; child = child->nextSibling) {
+                MctsNode* childCopy = allocate(child->grid, child->reward, child->move);
+                if (childCopy == nullptr) {
+                    complete = false;
+                    break;
+                }
+                children.push_back(childCopy);
+            }
+            // The copies of a decision node's partial list are left unreachable
+            if (!complete && decision) {
+                continue;
+            }
+
+            MctsNode* previous = nullptr;
+            const MctsNode* child = source->firstChild.load(std::memory_order_acquire);
+            for (MctsNode* childCopy : children) {
+                if (previous == nullptr) {
+                    copy->firstChild.store(childCopy, std::memory_order_relaxed);
+                } else {
+                    previous->nextSibling = childCopy;
+                }
+                previous = childCopy;
+                stack.emplace_back(child, childCopy, !decision);
+                child = child->nextSibling;
+            }
+        }
+        tree.root = root;
+    }
+
+    // The root gets a chance node per legal move whatever could be copied, so
+    // that the search covers every move even once the arenas are full
+    int missing = legalMoves(grid);
+    for (MctsNode* child = tree.root->firstChild.load(std::memory_order_relaxed); child != nullptr; child = child->nextSibling) {
+        missing &= ~(1 << child->move);
+    }
+    for (int m = NUMBER_OF_MOVES - 1; m >= 0; --m) {
+        if (!isMoveLegal(missing, static_cast<Move>(m))) {
+            continue;
+        }
+        uint32_t reward = 0;
+        Grid afterstate = moveGrid(grid, static_cast<Move>(m), reward);
+        MctsNode* child = allocate(afterstate, reward, m);
+        if (child == nullptr) {
+            break;
+        }
+        child->nextSibling = tree.root->firstChild.load(std::memory_order_relaxed);
+        tree.root->firstChild.store(child, std::memory_order_relaxed);
+    }
+    tree.generations[tree.active].reset();
+    tree.active = 1 - tree.active;
+}
+
+// A decision node is expanded on its second visit, with a chance node per
+// legal move. The moves missing from its list, all of them the first time,
+// are built aside and published at once in front of it. A thread losing the
+// race looks at the list again and drops its copies of the moves added by the
+// winner. Returns the list as is if the arena is full, so null if the game is
+// over or nothing could be added to an empty list.
+MctsNode* Mcts::expand(Arena& arena, MctsNode* node) {
+    int legal = legalMoves(node->grid);
+    MctsNode* head = node->firstChild.load(std::memory_order_acquire);
+    std::array<MctsNode*, NUMBER_OF_MOVES> created = {};
+    for (;;) {
+        int missing = legal;
+        for (MctsNode* child = head; child != nullptr; child = child->nextSibling) {
+            missing &= ~(1 << child->move);
+        }
+        if (missing == 0) {
+            return head;
+        }
+
+        MctsNode* list = head;
+        for (int m = NUMBER_OF_MOVES - 1; m >= 0; --m) {
+            if (!isMoveLegal(missing, static_cast<Move>(m))) {
+                continue;
+            }
+            if (created[m] == nullptr) {
+                uint32_t reward = 0;
+                Grid afterstate = moveGrid(node->grid, static_cast<Move>(m), reward);
+                created[m] = makeNode(arena, afterstate, reward, m);
+                if (created[m] == nullptr) {
+                    return head;
+                }
+            }
+            created[m]->nextSibling = list;
+            list = created[m];
+        }
+
+        if (node->firstChild.compare_exchange_weak(head, list, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return list;
+        }
+    }
+}
+
+// UCT over the moves, an unvisited move first. The values are divided by the
+// mean value of the node so that one constant fits every stage of the game.
+MctsNode* Mcts::select(MctsNode* node, MctsNode* children) const {
+    int parentVisits = std::max(1, node->visits.load(std::memory_order_relaxed));
+    double scale = std::max(1.0, node->total.load(std::memory_order_relaxed) / parentVisits);
+    double logVisits = std::log(static_cast<double>(parentVisits));
+
+    MctsNode* best = children;
+    double bestValue = -std::numeric_limits<double>::infinity();
+    for (MctsNode* child = children; child != nullptr; child = child->nextSibling) {
+        int visits = child->visits.load(std::memory_order_relaxed);
+        if (visits <= 0) {
+            return child;
+        }
+        double mean = child->reward + child->total.load(std::memory_order_relaxed) / visits;
+        double value = mean / scale + options_.exploration * std::sqrt(logVisits / visits);
+        if (value > bestValue) {
+            bestValue = value;
+            best = child;
+        }
+    }
+    return best;
+}
+
+// Finds or inserts the decision node of a spawn. A new node goes in front of
+// the list, when another thread got there first the list is scanned again
+// since it may have inserted the same grid. Null if the arena is full.
+MctsNode* Mcts::spawnChild(Arena& arena, MctsNode* chance, Grid grid) {
+    MctsNode* head = chance->firstChild.load(std::memory_order_acquire);
+    MctsNode* created = nullptr;
+    for (;;) {
+        for (MctsNode* child = head; child != nullptr; child = child->nextSibling) {
+            if (child->grid == grid) {
+                return child;
+            }
+        }
+        if (created == nullptr) {
+            created = makeNode(arena, grid, 0, 0);
+            if (created == nullptr) {
+                return nullptr;
+            }
+        }
+        created->nextSibling = head;
+        if (chance->firstChild.compare_exchange_weak(head, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return created;
+        }
+    }
+}
+
+// Descends by UCT at decision nodes and by sampling a spawn at chance nodes
+// down to a new or terminal position, plays it out and backs the score gained
+// up the path. Chance nodes hold the gain from their afterstate, decision
+// nodes add the reward of the move played below them.
+void Mcts::playout(MctsNode* root, Arena& arena, Rng& gen, std::vector<MctsNode*>& path) {
+    path.clear();
+    MctsNode* node = root;
+    path.push_back(node);
+
+    Board leaf;
+    for (;;) {
+        if (node->visits.load(std::memory_order_relaxed) == 0) {
+            leaf.grid = node->grid;
+            break;
+        }
+        MctsNode* children = expand(arena, node);
+        if (children == nullptr) {
+            leaf.grid = node->grid;
+            break;
+        }
+
+        MctsNode* chance = select(node, children);
+        chance->visits.fetch_add(options_.virtualLoss, std::memory_order_relaxed);
+        path.push_back(chance);
+
+        Board spawned;
+        spawned.grid = chance->grid;
+        addRandomTile(spawned, gen);
+        node = spawnChild(arena, chance, spawned.grid);
+        if (node == nullptr) {
+            leaf.grid = spawned.grid;
+            break;
+        }
+        path.push_back(node);
+    }
+
+    double gain = simulate(leaf, gen, options_.rollout);
+    for (size_t i = path.size(); i-- > 0;) {
+        MctsNode* visited = path[i];
+        bool isChance = i % 2 == 1;
+        visited->visits.fetch_add(isChance ? 1 - options_.virtualLoss : 1, std::memory_order_relaxed);
+        addValue(visited->total, gain);
+        if (isChance) {
+            gain += visited->reward;
+        }
+    }
+}
+
+MctsResult Mcts::run(const Board& board, bool timed, std::chrono::steady_clock::time_point deadline) {
+    auto start = std::chrono::steady_clock::now();
+    MctsResult result;
+    // On the pool, so that the workers touch the chunks of their own arenas
+    pool_.parallelFor(0, static_cast<int>(trees_.size()), 1, [&](int t) {
+        prepareRoot(*trees_[t], board.grid);
+    });
+    for (std::unique_ptr<Tree>& tree : trees_) {
+        result.reusedVisits += tree->root->visits.load(std::memory_order_relaxed);
+    }
+
+    // Every task claims playouts from a shared counter and allocates from the
+    // arena of its worker, under root parallelism each task owns a tree and
+    // plays its share on it
+    int numberOfTasks = options_.numThreads;
+    bool rootParallel = options_.parallelism == MctsParallelism::ROOT;
+    std::atomic<int> claimed(0);
+    std::vector<int> played(numberOfTasks, 0);
+    pool_.parallelFor(0, numberOfTasks, 1, [&](int task) {
+        Tree& tree = *trees_[rootParallel ? task : 0];
+        Arena& arena = tree.generations[tree.active][rootParallel ? 0 : pool_.currentWorker()];
+        int share = rootParallel ? (options_.iterations + numberOfTasks - 1 - task) / numberOfTasks : options_.iterations;
+        for (;;) {
+            if (timed) {
+                if (played[task] % 16 == 0 && std::chrono::steady_clock::now() >= deadline && played[task] > 0) {
+                    break;
+                }
+            } else if (rootParallel ? played[task] >= share : claimed.fetch_add(1, std::memory_order_relaxed) >= share) {
+                break;
+            }
+            playout(tree.root, arena, generators_[task], paths_[task]);
+            ++played[task];
+        }
+    });
+
+    std::array<double, NUMBER_OF_MOVES> totals{};
+    result.visits.fill(0);
+    for (std::unique_ptr<Tree>& tree : trees_) {
+        for (MctsNode* chance = tree->root->firstChild.load(std::memory_order_acquire); chance != nullptr; chance = chance->nextSibling) {
+            int visits = chance->visits.load(std::memory_order_relaxed);
+            result.visits[chance->move] += visits;
+            totals[chance->move] += chance->reward * static_cast<double>(visits) + chance->total.load(std::memory_order_relaxed);
+        }
+    }
+
+    // The most visited move is played, ties going to the better mean
+    int best = -1;
+    for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+        result.values[m] = result.visits[m] > 0 ? totals[m] / result.visits[m] : -std::numeric_limits<double>::infinity();
+        if (result.visits[m] > 0 && (best < 0 || result.visits[m] > result.visits[best]
+            || (result.visits[m] == result.visits[best] && result.values[m] > result.values[best]))) {
+            best = m;
+        }
+    }
+    if (best < 0) {
+        int legal = legalMoves(board.grid);
+        best = legal != 0 ? __builtin_ctz(legal) : 0;
+    }
+    result.move = static_cast<Move>(best);
+
+    for (int count : played) {
+        result.playouts += count;
+    }
+    playoutsPlayed_ += static_cast<uint64_t>(result.playouts);
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
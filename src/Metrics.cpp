@@ -0,0 +1,303 @@
+// Runtime counters and latency histograms of the solver and its pool
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+// Exported names of the counters, the time counters are exported in seconds
+static const char* const COUNTER_NAMES[NUMBER_OF_COUNTERS] = {
+    "decisions", "book_hits", "rollouts", "moves", "table_hits", "table_misses", "jobs", "busy_seconds", "idle_seconds",
+};
+
+static double counterValue(const MetricsSnapshot::Counters& counters, int counter) {
+    bool nanoseconds = counter == static_cast<int>(Counter::BUSY_NANOSECONDS)
+        || counter == static_cast<int>(Counter::IDLE_NANOSECONDS);
+    return nanoseconds ? counters[counter] * 1e-9 : static_cast<double>(counters[counter]);
+}
+
+static double seconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+static int64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+// Values below 8 ns get a bucket each, above that a power of two is split in
+// eight buckets by the three bits following the leading one
+int LatencyHistogram::bucketIndex(uint64_t nanoseconds) {
+    if (nanoseconds < (uint64_t(1) << SUB_BUCKET_BITS)) {
+        return static_cast<int>(nanoseconds);
+    }
+    int exponent = 63 - __builtin_clzll(nanoseconds);
+    int sub = static_cast<int>((nanoseconds >> (exponent - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1));
+    return ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < (1 << SUB_BUCKET_BITS)) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = (index >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    uint64_t sub = static_cast<uint64_t>(index & ((1 << SUB_BUCKET_BITS) - 1));
+    int shift = exponent - SUB_BUCKET_BITS;
+    return (((uint64_t(1) << SUB_BUCKET_BITS) + sub) << shift) + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    uint64_t nanoseconds = static_cast<uint64_t>(std::max<int64_t>(0, latency.count()));
+    buckets_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max && !max_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double q) const {
+    uint64_t count = count_.load(std::memory_order_relaxed);
+    if (count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::min(1.0, std::max(0.0, q)) * count)));
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    uint64_t seen = 0;
+    for (int index = 0; index < NUMBER_OF_BUCKETS; ++index) {
+        seen += buckets_[index].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::chrono::nanoseconds(static_cast<int64_t>(std::min(bucketUpperBound(index), max)));
+        }
+    }
+    return std::chrono::nanoseconds(static_cast<int64_t>(max));
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    LatencySummary summary;
+    summary.count = count_.load(std::memory_order_relaxed);
+    summary.total = std::chrono::nanoseconds(static_cast<int64_t>(total_.load(std::memory_order_relaxed)));
+    summary.p50 = percentile(0.5);
+    summary.p90 = percentile(0.9);
+    summary.p99 = percentile(0.99);
+    summary.max = std::chrono::nanoseconds(static_cast<int64_t>(max_.load(std::memory_order_relaxed)));
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t MetricsSnapshot::total(Counter counter) const {
+    return totals[static_cast<int>(counter)];
+}
+
+double MetricsSnapshot::perSecond(Counter counter) const {
+    return uptime.count() > 0 ? total(counter) / seconds(uptime) : 0.0;
+}
+
+double MetricsSnapshot::perSearchSecond(Counter counter) const {
+    return decisionLatency.total.count() > 0 ? total(counter) / seconds(decisionLatency.total) : 0.0;
+}
+
+double MetricsSnapshot::tableHitRate() const {
+    uint64_t probes = total(Counter::TABLE_HITS) + total(Counter::TABLE_MISSES);
+    return probes > 0 ? static_cast<double>(total(Counter::TABLE_HITS)) / probes : 0.0;
+}
+
+static void writeJsonLatency(std::ostream& out, const char* name, const LatencySummary& summary) {
+    out << "\"" << name << "\":{\"count\":" << summary.count << ",\"sum\":" << seconds(summary.total)
+        << ",\"p50\":" << seconds(summary.p50) << ",\"p90\":" << seconds(summary.p90)
+        << ",\"p99\":" << seconds(summary.p99) << ",\"max\":" << seconds(summary.max) << "}";
+}
+
+std::string MetricsSnapshot::toJson() const {
+    std::ostringstream out;
+    out.precision(9);
+
+    out << "{\"uptime_seconds\":" << seconds(uptime);
+    for (int counter = 0; counter < NUMBER_OF_COUNTERS; ++counter) {
+        out << ",\"" << COUNTER_NAMES[counter] << "\":" << counterValue(totals, counter);
+    }
+    out << ",\"table_hit_rate\":" << tableHitRate()
+        << ",\"rollouts_per_second\":" << perSecond(Counter::ROLLOUTS)
+        << ",\"moves_per_second\":" << perSecond(Counter::MOVES)
+        << ",\"rollouts_per_search_second\":" << perSearchSecond(Counter::ROLLOUTS)
+        << ",\"moves_per_search_second\":" << perSearchSecond(Counter::MOVES) << ",";
+    writeJsonLatency(out, "decision_latency_seconds", decisionLatency);
+    out << ",";
+    writeJsonLatency(out, "queue_wait_seconds", queueWait);
+
+    out << ",\"threads\":[";
+    for (size_t thread = 0; thread < threads.size(); ++thread) {
+        out << (thread > 0 ? ",{" : "{") << "\"thread\":" << thread;
+        for (int counter = 0; counter < NUMBER_OF_COUNTERS; ++counter) {
+            out << ",\"" << COUNTER_NAMES[counter] << "\":" << counterValue(threads[thread], counter);
+        }
+        out << "}";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+static void writePrometheusLatency(std::ostream& out, const std::string& name, const char* help, const LatencySummary& summary) {
+    out << "# HELP " << name << " " << help << "\n"
+        << "# TYPE " << name << " summary\n"
+        << name << "{quantile=\"0.5\"} " << seconds(summary.p50) << "\n"
+        << name << "{quantile=\"0.9\"} " << seconds(summary.p90) << "\n"
+        << name << "{quantile=\"0.99\"} " << seconds(summary.p99) << "\n"
+        << name << "{quantile=\"1\"} " << seconds(summary.max) << "\n"
+        << name << "_sum " << seconds(summary.total) << "\n"
+        << name << "_count " << summary.count << "\n";
+}
+
+static void writePrometheusGauge(std::ostream& out, const std::string& name, const char* help, double value) {
+    out << "# HELP " << name << " " << help << "\n"
+        << "# TYPE " << name << " gauge\n"
+        << name << " " << value << "\n";
+}
+
+// Counters are exported per thread, the totals are left to the queries
+std::string MetricsSnapshot::toPrometheus() const {
+    std::ostringstream out;
+    out.precision(9);
+
+    for (int counter = 0; counter < NUMBER_OF_COUNTERS; ++counter) {
+        std::string name = std::string("solver_") + COUNTER_NAMES[counter] + "_total";
+        out << "# TYPE " << name << " counter\n";
+        for (size_t thread = 0; thread < threads.size(); ++thread) {
+            out << name << "{thread=\"" << thread << "\"} " << counterValue(threads[thread], counter) << "\n";
+        }
+    }
+
+    writePrometheusGauge(out, "solver_uptime_seconds", "Time since the metrics were reset", seconds(uptime));
+    writePrometheusGauge(out, "solver_table_hit_rate", "Fraction of the table probes that hit", tableHitRate());
+    writePrometheusGauge(out, "solver_rollouts_per_search_second", "Rollouts per second spent searching",
+        perSearchSecond(Counter::ROLLOUTS));
+    writePrometheusGauge(out, "solver_moves_per_search_second", "Rollout moves per second spent searching",
+        perSearchSecond(Counter::MOVES));
+    writePrometheusLatency(out, "solver_decision_latency_seconds", "Time to choose a move", decisionLatency);
+    writePrometheusLatency(out, "solver_queue_wait_seconds", "Time a submitted job waited for a worker", queueWait);
+    return out.str();
+}
+
+Metrics::Metrics() : id_(nextId()), start_(steadyNanoseconds()) {}
+
+uint64_t Metrics::nextId() {
+    static std::atomic<uint64_t> next(1);
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// A thread keeps the slot of the last instance it recorded to, switching
+// instances costs a lookup under the lock
+Metrics::ThreadCounters& Metrics::local() {
+    static thread_local uint64_t cachedOwner = 0;
+    static thread_local ThreadCounters* cachedCounters = nullptr;
+    if (cachedOwner == id_) {
+        return *cachedCounters;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::thread::id thread = std::this_thread::get_id();
+    auto found = std::find_if(threads_.begin(), threads_.end(), [&](const std::unique_ptr<ThreadCounters>& counters) {
+        return counters->thread == thread;
+    });
+    if (found == threads_.end()) {
+        threads_.push_back(std::make_unique<ThreadCounters>());
+        threads_.back()->thread = thread;
+        for (std::atomic<uint64_t>& value : threads_.back()->values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+        found = threads_.end() - 1;
+    }
+
+    cachedOwner = id_;
+    cachedCounters = found->get();
+    return *cachedCounters;
+}
+
+void Metrics::add(Counter counter, uint64_t amount) {
+    local().values[static_cast<int>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void Metrics::recordDecision(std::chrono::nanoseconds latency) {
+    decisionLatency_.record(latency);
+}
+
+void Metrics::recordQueueWait(std::chrono::nanoseconds latency) {
+    queueWait_.record(latency);
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+    MetricsSnapshot snapshot;
+    snapshot.uptime = std::chrono::nanoseconds(steadyNanoseconds() - start_.load(std::memory_order_relaxed));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::unique_ptr<ThreadCounters>& counters : threads_) {
+            MetricsSnapshot::Counters values;
+            for (int counter = 0; counter < NUMBER_OF_COUNTERS; ++counter) {
+                values[counter] = counters->values[counter].load(std::memory_order_relaxed);
+                snapshot.totals[counter] += values[counter];
+            }
+            snapshot.threads.push_back(values);
+        }
+    }
+
+    snapshot.decisionLatency = decisionLatency_.summary();
+    snapshot.queueWait = queueWait_.summary();
+    return snapshot;
+}
+
+// The slots are zeroed rather than dropped, threads keep pointers to them
+void Metrics::reset() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::unique_ptr<ThreadCounters>& counters : threads_) {
+            for (std::atomic<uint64_t>& value : counters->values) {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    decisionLatency_.reset();
+    queueWait_.reset();
+    start_.store(steadyNanoseconds(), std::memory_order_relaxed);
+}
+
+void Metrics::dump(const std::string& path, MetricsFormat format) const {
+    MetricsSnapshot current = snapshot();
+    std::string text = format == MetricsFormat::PROMETHEUS ? current.toPrometheus() : current.toJson();
+
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("cannot create metrics file " + temporaryPath);
+    }
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (std::fclose(file) != 0 || !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw std::runtime_error("cannot write metrics file " + path);
+    }
+}
+
+MetricsFormat metricsFormatForPath(const std::string& path) {
+    const std::string extension = ".prom";
+    bool prometheus = path.size() >= extension.size()
+        && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    return prometheus ? MetricsFormat::PROMETHEUS : MetricsFormat::JSON;
+}
@@ -2,75 +2,145 @@
 // Author: Fabrice Renard
 // Date : 23 / 06 / 2023
 
+#include <limits>
+
 #include "MonteCarlo.hpp"
+#include "Solver.hpp"
 
-std::unique_ptr<Game> move(const Game& game, Move move) {
-    std::unique_ptr<Game> newGame = std::make_unique<Game>(game);
-    switch (move) {
-        case Move::LEFT:
-            newGame->moveLeft();
-            break;
-        case Move::RIGHT:
-            newGame->moveRight();
-            break;
-        case Move::UP:
-            newGame->moveUp();
-            break;
-        case Move::DOWN:
-            newGame->moveDown();
-            break;
-        default:
-            break;
-    }
-    return newGame;
+Board move(const Board& board, Move move, Rng& localGen) {
+    Board newBoard = board;
+    playMove(newBoard, move, localGen);
+    return newBoard;
 }
 
-double simulate(std::unique_ptr<Game> game, std::ranlux48& localGen) {
-    std::uniform_int_distribution<int> intDistribution(0, 3);
-
+// The rollouts count the moves they play in moves, for the solver's metrics.
+// An illegal move leaves the board as it is, the mask saves sliding it
+static double rollout(Board board, Rng& localGen, uint64_t& moves) {
     double localScore = 0.0;
-    for (int i = 0; i < DEPTH && !game->isGameOver(); ++i) {
-        Move randomMove = static_cast<Move>(intDistribution(localGen));
-        game = move(*game, randomMove);
+    int legal = legalMoves(board.grid);
+    for (int i = 0; i < DEPTH && legal != 0; ++i) {
+        Move randomMove = static_cast<Move>(randomBelow(localGen, NUMBER_OF_MOVES));
+        if (isMoveLegal(legal, randomMove)) {
+            playMove(board, randomMove, localGen);
+            legal = legalMoves(board.grid);
+            ++moves;
+        }
     }
 
-    localScore += game->getScore();
+    localScore += board.score;
     return localScore;
 }
 
-double runSimulations(const Game& game, Move currentMove, int numberOfSimulations) {
-    thread_local std::random_device rd;
-    thread_local std::ranlux48 gen(rd());
+// Uniform play cut off after depth moves, the illegal moves count as moves
+static double rolloutUniform(Board board, Rng& localGen, const RolloutOptions& options, uint64_t& moves) {
+    int legal = legalMoves(board.grid);
+    for (int i = 0; i < options.depth; ++i) {
+        if (legal == 0) {
+            return board.score;
+        }
+        Move randomMove = static_cast<Move>(randomBelow(localGen, NUMBER_OF_MOVES));
+        if (isMoveLegal(legal, randomMove)) {
+            playMove(board, randomMove, localGen);
+            legal = legalMoves(board.grid);
+            ++moves;
+        }
+    }
 
-    double totalScore = 0.0;
+    if (options.evaluator != nullptr && legal != 0) {
+        return board.score + options.evaluator->evaluate(board.grid);
+    }
+    return board.score;
+}
 
-    for (int i = 0; i < numberOfSimulations; ++i) {
-        std::unique_ptr<Game> gameCopy = move(game, currentMove);
-        totalScore += simulate(std::move(gameCopy), gen);
+static double rollout(Board board, Rng& localGen, const RolloutOptions& options, uint64_t& moves) {
+    if (options.policy == RolloutPolicy::UNIFORM) {
+        return options.depth >= DEPTH && options.evaluator == nullptr
+            ? rollout(board, localGen, moves)
+            : rolloutUniform(board, localGen, options, moves);
     }
 
-    return totalScore;
-}
+    // The legal-move mask ends the game and restricts the draw without any
+    // slide, random moves then slide only the move they play
+    Grid afterstates[NUMBER_OF_MOVES];
+    uint32_t rewards[NUMBER_OF_MOVES];
+    for (int i = 0; i < options.depth; ++i) {
+        int legal = legalMoves(board.grid);
+        if (legal == 0) {
+            return board.score;
+        }
 
-Move performMC(const Game& game, int numberOfSimulationsPerMove, int numThreads) {
-    ThreadPool pool(numThreads);
-    std::vector<std::future<double>> futures;
+        int chosen;
+        bool explore = options.policy == RolloutPolicy::LEGAL_RANDOM
+            || (options.policy == RolloutPolicy::EPSILON_GREEDY
+                && static_cast<uint32_t>(localGen()) < options.epsilon * 4294967296.0);
+        if (explore) {
+            chosen = selectBit(legal, static_cast<int>(randomBelow(localGen, __builtin_popcount(legal))));
+            rewards[chosen] = 0;
+            afterstates[chosen] = moveGrid(board.grid, static_cast<Move>(chosen), rewards[chosen]);
+        } else {
+            chosen = 0;
+            double bestValue = -std::numeric_limits<double>::infinity();
+            for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+                if (!isMoveLegal(legal, static_cast<Move>(m))) {
+                    continue;
+                }
+                rewards[m] = 0;
+                afterstates[m] = moveGrid(board.grid, static_cast<Move>(m), rewards[m]);
+                double value = rewards[m] + (options.evaluator != nullptr ? options.evaluator->evaluate(afterstates[m]) : 0.0);
+                if (value > bestValue) {
+                    bestValue = value;
+                    chosen = m;
+                }
+            }
+        }
 
-    for (int j = 0; j < 4; ++j) {
-        for (int t = 0; t < numThreads; ++t) {
-            futures.push_back(pool.enqueue(runSimulations, std::cref(game), static_cast<Move>(j), numberOfSimulationsPerMove / numThreads));
+        board.grid = afterstates[chosen];
+        board.score += static_cast<int>(rewards[chosen]);
+        ++moves;
+        if (i + 1 == options.depth && options.evaluator != nullptr) {
+            return board.score + options.evaluator->evaluate(board.grid);
         }
+        addRandomTile(board, localGen);
     }
 
-    std::vector<double> scores(4, 0.0);
-    for (int j = 0; j < 4; ++j) {
-        for (int t = 0; t < numThreads; ++t) {
-            scores[j] += futures[j * numThreads + t].get();
-        }
+    return board.score;
+}
+
+double simulate(Board board, Rng& localGen) {
+    uint64_t moves = 0;
+    return rollout(board, localGen, moves);
+}
+
+double simulate(Board board, Rng& localGen, const RolloutOptions& options) {
+    uint64_t moves = 0;
+    return rollout(board, localGen, options, moves);
+}
+
+RolloutStats runSimulations(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen) {
+    return runSimulations(board, currentMove, numberOfSimulations, gen, RolloutOptions());
+}
+
+RolloutStats runSimulations(const Board& board, Move currentMove, int numberOfSimulations, Rng& gen, const RolloutOptions& options) {
+    RolloutStats stats;
+
+    for (int i = 0; i < numberOfSimulations; ++i) {
+        Board boardCopy = move(board, currentMove, gen);
+        double score = rollout(boardCopy, gen, options, stats.moves);
+        stats.total += score;
+        stats.totalSquares += score * score;
     }
 
-    auto bestMoveIter = std::max_element(scores.begin(), scores.end());
-    int bestMoveIndex = std::distance(scores.begin(), bestMoveIter);
+    stats.count = numberOfSimulations;
+    return stats;
+}
+
+Move performMC(const Board& board, int numberOfSimulationsPerMove, int numThreads, uint64_t seed, TranspositionTable* table) {
+    SolverOptions options;
+    options.numberOfSimulationsPerMove = numberOfSimulationsPerMove;
+    options.numThreads = numThreads;
+    options.seed = seed;
+    options.tableSizeInMegabytes = 0;
 
-    return static_cast<Move>(bestMoveIndex);
+    Solver solver(options, table);
+    return solver.bestMove(board);
 }
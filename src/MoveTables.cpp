@@ -0,0 +1,63 @@
+// Precomputed row tables used to execute moves on a packed grid
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "MoveTables.hpp"
+
+static Row reverseRow(Row row) {
+    return static_cast<Row>(((row & 0x000F) << 12) | ((row & 0x00F0) << 4) | ((row & 0x0F00) >> 4) | ((row & 0xF000) >> 12));
+}
+
+MoveTables::MoveTables() {
+    for (int index = 0; index < NUMBER_OF_ROWS; ++index) {
+        int tiles[GRID_SIZE];
+        int compressed[GRID_SIZE] = { 0 };
+        int count = 0;
+
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            tiles[col] = (index >> (col * 4)) & 0xF;
+            if (tiles[col] != 0) {
+                compressed[count++] = tiles[col];
+            }
+        }
+
+        uint32_t rowScore = 0;
+        int merged[GRID_SIZE] = { 0 };
+        int insertPos = 0;
+
+        for (int i = 0; i < count; ++i) {
+            // Two 32768 tiles cannot merge, a nibble holds at most 15
+            if (i + 1 < count && compressed[i] == compressed[i + 1] && compressed[i] != 0xF) {
+                int sum = compressed[i] + 1;
+                rowScore += (1u << sum);
+                merged[insertPos++] = sum;
+                ++i;
+            } else {
+                merged[insertPos++] = compressed[i];
+            }
+        }
+
+        Row result = 0;
+        for (int col = 0; col < GRID_SIZE; ++col) {
+            result |= static_cast<Row>(merged[col] << (col * 4));
+        }
+
+        Row row = static_cast<Row>(index);
+        left[row] = result;
+        score[row] = rowScore;
+        right[reverseRow(row)] = reverseRow(result);
+    }
+
+    // Merge scores are powers of two of at least 4 and a row scores at most
+    // 2 * 32768, so score / 4 always fits in 16 bits
+    for (int index = 0; index < NUMBER_OF_ROWS; ++index) {
+        packed[index] = left[index] | ((score[index] / 4) << ROW_BITS);
+        packed[NUMBER_OF_ROWS + index] = right[index] | ((score[index] / 4) << ROW_BITS);
+        movable[index] = static_cast<uint8_t>((left[index] != index ? 1 : 0) | (right[index] != index ? 2 : 0));
+    }
+}
+
+const MoveTables& moveTables() {
+    static const MoveTables tables;
+    return tables;
+}
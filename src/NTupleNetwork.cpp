@@ -0,0 +1,185 @@
+// N-tuple network estimating the score still to be gained from a board
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "NTupleNetwork.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "Random.hpp"
+
+constexpr char NTUPLE_MAGIC[8] = { '2', '0', '4', '8', 'N', 'T', 'N', '1' };
+constexpr uint32_t NTUPLE_VERSION = 1;
+constexpr size_t NTUPLE_HEADER_ALIGNMENT = 64;
+
+static size_t headerSize(size_t numberOfTuples) {
+    size_t size = sizeof(NTUPLE_MAGIC) + 2 * sizeof(uint32_t) + numberOfTuples * (MAX_TUPLE_LENGTH + 1);
+    return (size + NTUPLE_HEADER_ALIGNMENT - 1) / NTUPLE_HEADER_ALIGNMENT * NTUPLE_HEADER_ALIGNMENT;
+}
+
+// Relaxed atomic accesses compile to plain moves, they only keep the hogwild
+// updates of the trainer free of torn values
+static float loadWeight(const float* weight) {
+    float value;
+    __atomic_load(weight, &value, __ATOMIC_RELAXED);
+    return value;
+}
+
+static void storeWeight(float* weight, float value) {
+    __atomic_store(weight, &value, __ATOMIC_RELAXED);
+}
+
+std::vector<NTupleNetwork::Tuple> NTupleNetwork::standardTuples() {
+    return {
+        { 0, 1, 2, 3, 4, 5 },
+        { 4, 5, 6, 7, 8, 9 },
+        { 0, 1, 2, 4, 5, 6 },
+        { 4, 5, 6, 8, 9, 10 },
+    };
+}
+
+NTupleNetwork::NTupleNetwork(std::vector<Tuple> tuples)
+    : tuples_(std::move(tuples)), numberOfWeights_(0), weights_(nullptr) {
+    initializeTuples();
+    ownedWeights_.assign(numberOfWeights_, 0.0f);
+    weights_ = ownedWeights_.data();
+}
+
+NTupleNetwork::NTupleNetwork(std::vector<Tuple> tuples, std::unique_ptr<MappedFile> mapping, float* weights)
+    : tuples_(std::move(tuples)), numberOfWeights_(0), mapping_(std::move(mapping)), weights_(weights) {
+    initializeTuples();
+}
+
+void NTupleNetwork::initializeTuples() {
+    for (Tuple& tuple : tuples_) {
+        if (tuple.empty() || tuple.size() > MAX_TUPLE_LENGTH) {
+            throw std::invalid_argument("a tuple has 1 to 7 cells");
+        }
+
+        std::sort(tuple.begin(), tuple.end());
+        uint64_t mask = 0;
+        for (int cell : tuple) {
+            if (cell < 0 || cell >= GRID_SIZE * GRID_SIZE || (mask & (0xFULL << (cell * 4))) != 0) {
+                throw std::invalid_argument("tuple cells must be distinct cells of the grid");
+            }
+            mask |= 0xFULL << (cell * 4);
+        }
+
+        masks_.push_back(mask);
+        offsets_.push_back(numberOfWeights_);
+        numberOfWeights_ += size_t(1) << (4 * tuple.size());
+    }
+}
+
+std::unique_ptr<NTupleNetwork> NTupleNetwork::load(const std::string& path) {
+    auto mapping = std::make_unique<MappedFile>(path, true);
+    const unsigned char* data = mapping->data();
+    size_t size = mapping->size();
+
+    uint32_t header[2];
+    if (size < headerSize(0) || std::memcmp(data, NTUPLE_MAGIC, sizeof(NTUPLE_MAGIC)) != 0) {
+        throw std::runtime_error("invalid n-tuple network " + path);
+    }
+    std::memcpy(header, data + sizeof(NTUPLE_MAGIC), sizeof(header));
+    if (header[0] != NTUPLE_VERSION || size < headerSize(header[1])) {
+        throw std::runtime_error("invalid n-tuple network " + path);
+    }
+
+    std::vector<Tuple> tuples(header[1]);
+    size_t expectedSize = headerSize(header[1]);
+    const unsigned char* descriptor = data + sizeof(NTUPLE_MAGIC) + sizeof(header);
+    for (Tuple& tuple : tuples) {
+        int length = std::min<int>(descriptor[0], MAX_TUPLE_LENGTH);
+        tuple.assign(descriptor + 1, descriptor + 1 + length);
+        expectedSize += (size_t(1) << (4 * length)) * sizeof(float);
+        descriptor += MAX_TUPLE_LENGTH + 1;
+    }
+    if (size != expectedSize) {
+        throw std::runtime_error("truncated n-tuple network " + path);
+    }
+
+    float* weights = reinterpret_cast<float*>(mapping->mutableData() + headerSize(header[1]));
+    return std::unique_ptr<NTupleNetwork>(new NTupleNetwork(std::move(tuples), std::move(mapping), weights));
+}
+
+void NTupleNetwork::save(const std::string& path) const {
+    std::vector<unsigned char> header(headerSize(tuples_.size()), 0);
+    uint32_t fields[2] = { NTUPLE_VERSION, static_cast<uint32_t>(tuples_.size()) };
+    std::memcpy(header.data(), NTUPLE_MAGIC, sizeof(NTUPLE_MAGIC));
+    std::memcpy(header.data() + sizeof(NTUPLE_MAGIC), fields, sizeof(fields));
+
+    unsigned char* descriptor = header.data() + sizeof(NTUPLE_MAGIC) + sizeof(fields);
+    for (const Tuple& tuple : tuples_) {
+        descriptor[0] = static_cast<unsigned char>(tuple.size());
+        std::copy(tuple.begin(), tuple.end(), descriptor + 1);
+        descriptor += MAX_TUPLE_LENGTH + 1;
+    }
+
+    // Written aside then renamed, the destination may be the mapped file the
+    // weights are read from
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("cannot create n-tuple network " + temporaryPath);
+    }
+    bool written = std::fwrite(header.data(), 1, header.size(), file) == header.size()
+        && std::fwrite(weights_, sizeof(float), numberOfWeights_, file) == numberOfWeights_;
+    if (std::fclose(file) != 0 || !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw std::runtime_error("cannot write n-tuple network " + path);
+    }
+}
+
+size_t NTupleNetwork::tupleIndex(Grid grid, int tuple) const {
+#if defined(__BMI2__)
+    return offsets_[tuple] + _pext_u64(grid, masks_[tuple]);
+#else
+    size_t index = 0;
+    int shift = 0;
+    for (int cell : tuples_[tuple]) {
+        index |= static_cast<size_t>((grid >> (cell * 4)) & 0xF) << shift;
+        shift += 4;
+    }
+    return offsets_[tuple] + index;
+#endif
+}
+
+double NTupleNetwork::evaluate(Grid grid) const {
+    Grid symmetries[NUMBER_OF_SYMMETRIES];
+    symmetricGrids(grid, symmetries);
+
+    float value = 0.0f;
+    for (Grid symmetry : symmetries) {
+        for (int tuple = 0; tuple < static_cast<int>(tuples_.size()); ++tuple) {
+            value += loadWeight(weights_ + tupleIndex(symmetry, tuple));
+        }
+    }
+    return value;
+}
+
+void NTupleNetwork::update(Grid grid, float delta) {
+    Grid symmetries[NUMBER_OF_SYMMETRIES];
+    symmetricGrids(grid, symmetries);
+
+    for (Grid symmetry : symmetries) {
+        for (int tuple = 0; tuple < static_cast<int>(tuples_.size()); ++tuple) {
+            float* weight = weights_ + tupleIndex(symmetry, tuple);
+            storeWeight(weight, loadWeight(weight) + delta);
+        }
+    }
+}
+
+const std::vector<NTupleNetwork::Tuple>& NTupleNetwork::tuples() const {
+    return tuples_;
+}
+
+int NTupleNetwork::numberOfFeatures() const {
+    return NUMBER_OF_SYMMETRIES * static_cast<int>(tuples_.size());
+}
+
+size_t NTupleNetwork::numberOfWeights() const {
+    return numberOfWeights_;
+}
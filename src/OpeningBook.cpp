@@ -0,0 +1,98 @@
+// Precomputed best moves of frequently reached boards
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "OpeningBook.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+constexpr char BOOK_MAGIC[8] = { '2', '0', '4', '8', 'O', 'B', 'K', '1' };
+constexpr uint32_t BOOK_VERSION = 1;
+constexpr size_t BOOK_HEADER_SIZE = sizeof(BOOK_MAGIC) + 2 * sizeof(uint32_t);
+
+OpeningBook::OpeningBook(std::unique_ptr<MappedFile> mapping)
+    : mapping_(std::move(mapping)), entries_(nullptr), size_(0) {
+}
+
+std::unique_ptr<OpeningBook> OpeningBook::load(const std::string& path) {
+    auto mapping = std::make_unique<MappedFile>(path);
+    const unsigned char* data = mapping->data();
+    size_t size = mapping->size();
+
+    uint32_t header[2];
+    if (size < BOOK_HEADER_SIZE || std::memcmp(data, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0) {
+        throw std::runtime_error("invalid opening book " + path);
+    }
+    std::memcpy(header, data + sizeof(BOOK_MAGIC), sizeof(header));
+    if (header[0] != BOOK_VERSION) {
+        throw std::runtime_error("invalid opening book " + path);
+    }
+    if (size != BOOK_HEADER_SIZE + static_cast<size_t>(header[1]) * sizeof(BookEntry)) {
+        throw std::runtime_error("truncated opening book " + path);
+    }
+
+    std::unique_ptr<OpeningBook> book(new OpeningBook(std::move(mapping)));
+    book->entries_ = reinterpret_cast<const BookEntry*>(data + BOOK_HEADER_SIZE);
+    book->size_ = header[1];
+    return book;
+}
+
+void OpeningBook::write(const std::string& path, std::vector<BookEntry> entries) {
+    for (BookEntry& entry : entries) {
+        CanonicalGrid canonical = canonicalGrid(entry.key);
+        entry.key = canonical.key;
+        entry.move = static_cast<uint32_t>(symmetricMove(static_cast<Move>(entry.move), canonical.symmetry));
+    }
+    // Stable so that the last of several entries for one key is kept
+    std::stable_sort(entries.begin(), entries.end(), [](const BookEntry& left, const BookEntry& right) {
+        return left.key < right.key;
+    });
+    std::vector<BookEntry> unique;
+    unique.reserve(entries.size());
+    for (const BookEntry& entry : entries) {
+        if (!unique.empty() && unique.back().key == entry.key) {
+            unique.back() = entry;
+        } else {
+            unique.push_back(entry);
+        }
+    }
+
+    unsigned char header[BOOK_HEADER_SIZE];
+    uint32_t fields[2] = { BOOK_VERSION, static_cast<uint32_t>(unique.size()) };
+    std::memcpy(header, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    std::memcpy(header + sizeof(BOOK_MAGIC), fields, sizeof(fields));
+
+    std::string temporaryPath = path + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        throw std::runtime_error("cannot create opening book " + temporaryPath);
+    }
+    bool written = std::fwrite(header, 1, sizeof(header), file) == sizeof(header)
+        && std::fwrite(unique.data(), sizeof(BookEntry), unique.size(), file) == unique.size();
+    if (std::fclose(file) != 0 || !written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        throw std::runtime_error("cannot write opening book " + path);
+    }
+}
+
+bool OpeningBook::probe(Grid grid, Move& move, float& value) const {
+    CanonicalGrid canonical = canonicalGrid(grid);
+    const BookEntry* end = entries_ + size_;
+    const BookEntry* entry = std::lower_bound(entries_, end, canonical.key, [](const BookEntry& candidate, Grid key) {
+        return candidate.key < key;
+    });
+    if (entry == end || entry->key != canonical.key || entry->move >= NUMBER_OF_MOVES) {
+        return false;
+    }
+
+    move = symmetricMove(static_cast<Move>(entry->move), inverseSymmetry(canonical.symmetry));
+    value = entry->value;
+    return true;
+}
+
+size_t OpeningBook::size() const {
+    return size_;
+}
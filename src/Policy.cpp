@@ -0,0 +1,180 @@
+// Policies choosing the move to play, one per search engine
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "Policy.hpp"
+#include "HeuristicEvaluator.hpp"
+#include "NTupleNetwork.hpp"
+
+static SolverOptions withBook(SolverOptions options, const OpeningBook* book) {
+    if (book != nullptr) {
+        options.book = book;
+    }
+    return options;
+}
+
+MonteCarloPolicy::MonteCarloPolicy(SolverOptions options, std::shared_ptr<const Evaluator> evaluator,
+    std::shared_ptr<const OpeningBook> book)
+    : evaluator_(std::move(evaluator)), book_(std::move(book)), solver_(withBook(options, book_.get())) {
+}
+
+Move MonteCarloPolicy::bestMove(const Board& board) {
+    lastResult_ = solver_.search(board);
+    hasValues_ = true;
+    return lastResult_.move;
+}
+
+Move MonteCarloPolicy::bestMove(const Board& board, std::chrono::microseconds budget) {
+    lastResult_ = solver_.search(board, budget);
+    hasValues_ = true;
+    return lastResult_.move;
+}
+
+void MonteCarloPolicy::ponder(const Board& board, std::chrono::microseconds budget) {
+    solver_.ponder(board, budget);
+}
+
+void MonteCarloPolicy::newGame() {
+    solver_.newGame();
+}
+
+void MonteCarloPolicy::reseed(uint64_t seed) {
+    solver_.reseed(seed);
+}
+
+uint64_t MonteCarloPolicy::rolloutsPlayed() const {
+    return solver_.rolloutsPlayed();
+}
+
+// Searches without any round still value every move: a forced move by its
+// afterstate, a book move by the book, illegal moves by -infinity
+bool MonteCarloPolicy::lastValues(std::array<double, NUMBER_OF_MOVES>& values) const {
+    if (!hasValues_) {
+        return false;
+    }
+    values = lastResult_.values;
+    return true;
+}
+
+ExpectimaxPolicy::ExpectimaxPolicy(ExpectimaxOptions options, std::shared_ptr<const Evaluator> evaluator,
+    std::shared_ptr<const OpeningBook> book, size_t tableSizeInMegabytes)
+    : evaluator_(std::move(evaluator)), book_(std::move(book)), table_(tableSizeInMegabytes),
+      expectimax_(options, &table_, evaluator_.get()) {
+}
+
+static bool bookMove(const OpeningBook* book, Grid grid, Move& move) {
+    float value;
+    return book != nullptr && book->probe(grid, move, value) && isMoveLegal(legalMoves(grid), move);
+}
+
+Move ExpectimaxPolicy::bestMove(const Board& board) {
+    Move move;
+    return bookMove(book_.get(), board.grid, move) ? move : expectimax_.bestMove(board);
+}
+
+Move ExpectimaxPolicy::bestMove(const Board& board, std::chrono::microseconds budget) {
+    Move move;
+    return bookMove(book_.get(), board.grid, move) ? move : expectimax_.bestMove(board, budget);
+}
+
+void ExpectimaxPolicy::newGame() {
+    table_.clear();
+}
+
+MctsPolicy::MctsPolicy(MctsOptions options, std::shared_ptr<const Evaluator> evaluator, std::shared_ptr<const OpeningBook> book)
+    : evaluator_(std::move(evaluator)), book_(std::move(book)), mcts_(options) {
+}
+
+Move MctsPolicy::keep(const Board& board, const MctsResult& result) {
+    for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+        lastValues_[m] = board.score + result.values[m];
+    }
+    hasValues_ = result.playouts > 0;
+    return result.move;
+}
+
+Move MctsPolicy::bestMove(const Board& board) {
+    Move move;
+    hasValues_ = false;
+    return bookMove(book_.get(), board.grid, move) ? move : keep(board, mcts_.search(board));
+}
+
+Move MctsPolicy::bestMove(const Board& board, std::chrono::microseconds budget) {
+    Move move;
+    hasValues_ = false;
+    return bookMove(book_.get(), board.grid, move) ? move : keep(board, mcts_.search(board, budget));
+}
+
+void MctsPolicy::newGame() {
+    mcts_.newGame();
+}
+
+void MctsPolicy::reseed(uint64_t seed) {
+    mcts_.reseed(seed);
+}
+
+uint64_t MctsPolicy::rolloutsPlayed() const {
+    return mcts_.playoutsPlayed();
+}
+
+bool MctsPolicy::lastValues(std::array<double, NUMBER_OF_MOVES>& values) const {
+    if (!hasValues_) {
+        return false;
+    }
+    values = lastValues_;
+    return true;
+}
+
+SolverOptions monteCarloOptions(int numThreads, const Evaluator* evaluator) {
+    SolverOptions options;
+    options.numThreads = numThreads;
+    // With an evaluator, short greedy rollouts beat playing to the end
+    if (evaluator != nullptr) {
+        options.rollout.policy = RolloutPolicy::GREEDY;
+        options.rollout.depth = TRUNCATED_ROLLOUT_DEPTH;
+        options.rollout.evaluator = evaluator;
+    }
+    return options;
+}
+
+std::unique_ptr<Policy> makePolicy(Engine engine, int numThreads, std::shared_ptr<const Evaluator> evaluator,
+    std::shared_ptr<const OpeningBook> book) {
+    switch (engine) {
+    case Engine::EXPECTIMAX:
+        return std::make_unique<ExpectimaxPolicy>(ExpectimaxOptions(), std::move(evaluator), std::move(book));
+    case Engine::MCTS: {
+        MctsOptions options;
+        options.numThreads = numThreads;
+        options.rollout = monteCarloOptions(numThreads, evaluator.get()).rollout;
+        return std::make_unique<MctsPolicy>(options, std::move(evaluator), std::move(book));
+    }
+    case Engine::MONTE_CARLO:
+    default: {
+        SolverOptions options = monteCarloOptions(numThreads, evaluator.get());
+        return std::make_unique<MonteCarloPolicy>(options, std::move(evaluator), std::move(book));
+    }
+    }
+}
+
+bool parseEngine(const std::string& name, Engine& engine) {
+    if (name == "mc" || name == "montecarlo") {
+        engine = Engine::MONTE_CARLO;
+        return true;
+    }
+    if (name == "expectimax") {
+        engine = Engine::EXPECTIMAX;
+        return true;
+    }
+    if (name == "mcts") {
+        engine = Engine::MCTS;
+        return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const Evaluator> makeEvaluator(const std::string& name) {
+    if (name == "heuristic") {
+        return std::make_shared<HeuristicEvaluator>();
+    }
+    return NTupleNetwork::load(name);
+}
@@ -0,0 +1,386 @@
+// Long-lived solver reusing its workers, generators and caches across moves
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <cmath>
+#include <limits>
+
+#include "Solver.hpp"
+
+// Rollout results are cached under the grid reached by sliding the root, salted
+// so that they never mix with the values other engines store in a shared table.
+// The value is the mean score gained after that grid, the depth the number of
+// rollouts it was averaged over and the spread their standard deviation.
+static Grid rolloutKey(Grid afterGrid, bool canonical) {
+    return (canonical ? canonicalKey(afterGrid) : afterGrid) ^ ROLLOUT_KEY_SALT;
+}
+
+// Keeps the batch generators apart from the per-task ones of single searches
+constexpr uint64_t BATCH_SEED_SALT = 0x6A09E667F3BCC908ULL;
+
+double Solver::MoveStatistics::mean() const {
+    return count > 0 ? total / count : afterBoard.score;
+}
+
+double Solver::MoveStatistics::deviation() const {
+    return count > 0 ? std::sqrt(std::max(0.0, totalSquares / count - mean() * mean())) : 0.0;
+}
+
+double Solver::MoveStatistics::standardError() const {
+    if (count < 2) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return deviation() / std::sqrt(count);
+}
+
+Solver::Solver(SolverOptions options, TranspositionTable* sharedTable)
+    : options_(options),
+      ownedMetrics_(options.metrics == nullptr ? std::make_unique<Metrics>() : nullptr),
+      metrics_(options.metrics != nullptr ? options.metrics : ownedMetrics_.get()),
+      pool_(std::max(1, options.numThreads), metrics_),
+      table_(sharedTable) {
+    options_.numThreads = std::max(1, options_.numThreads);
+
+    for (int i = 0; i < NUMBER_OF_MOVES * options_.numThreads; ++i) {
+        generators_.emplace_back(deriveSeed(options_.seed, i));
+    }
+
+    if (table_ == nullptr && options_.tableSizeInMegabytes > 0) {
+        ownedTable_ = std::make_unique<TranspositionTable>(options_.tableSizeInMegabytes);
+        table_ = ownedTable_.get();
+    }
+
+    taskStats_.resize(NUMBER_OF_MOVES * options_.numThreads);
+
+    if (options_.pinThreads) {
+        pool_.pinWorkers();
+    }
+}
+
+Move Solver::bestMove(Grid grid) {
+    Board board;
+    board.grid = grid;
+    return bestMove(board);
+}
+
+Move Solver::bestMove(const Board& board) {
+    return search(board).move;
+}
+
+Move Solver::bestMove(Grid grid, std::chrono::microseconds budget) {
+    Board board;
+    board.grid = grid;
+    return search(board, budget).move;
+}
+
+SearchResult Solver::search(const Board& board) {
+    return searchFixed(board, statistics_, nullptr, table_);
+}
+
+// Plays the rounds on the pool, or serially with gen when given one
+SearchResult Solver::searchFixed(const Board& board, Statistics& statistics, Rng* gen, TranspositionTable* table) {
+    auto start = std::chrono::steady_clock::now();
+    SearchResult bookResult;
+    if (probeBook(board, bookResult)) {
+        return bookResult;
+    }
+    std::vector<int> candidates = prepareSearch(board, statistics, table);
+    int numberOfSimulationsPerMove = options_.numberOfSimulationsPerMove;
+
+    // Successive halving over k moves runs ceil(log2(k)) rounds on a budget of
+    // k * numberOfSimulationsPerMove rollouts, uniform runs a single round
+    int numberOfCandidates = static_cast<int>(candidates.size());
+    int rounds = 1;
+    if (options_.rootAllocation == RootAllocation::SUCCESSIVE_HALVING) {
+        while ((1 << rounds) < numberOfCandidates) {
+            rounds++;
+        }
+    }
+    int budget = numberOfSimulationsPerMove * numberOfCandidates;
+    int roundsPlayed = 0;
+
+    for (int round = 0; round < rounds && candidates.size() > 1; ++round) {
+        int rolloutsPerCandidate = options_.rootAllocation == RootAllocation::UNIFORM
+            ? numberOfSimulationsPerMove
+            : std::max(1, budget / (static_cast<int>(candidates.size()) * rounds));
+
+        runRound(board, statistics, candidates, rolloutsPerCandidate, gen);
+        roundsPlayed++;
+
+        if (options_.rootAllocation == RootAllocation::UNIFORM) {
+            break;
+        }
+
+        eliminateDominated(statistics, candidates);
+        std::sort(candidates.begin(), candidates.end(), [&statistics](int a, int b) {
+            return statistics[a].mean() > statistics[b].mean();
+        });
+        candidates.resize((candidates.size() + 1) / 2);
+    }
+
+    SearchResult result = finishSearch(board, statistics, candidates, roundsPlayed, start, table);
+    recordDecision(result);
+    return result;
+}
+
+SearchResult Solver::search(const Board& board, std::chrono::microseconds budget) {
+    SearchResult bookResult;
+    if (probeBook(board, bookResult)) {
+        return bookResult;
+    }
+    SearchResult result = searchAnytime(board, budget);
+    recordDecision(result);
+    return result;
+}
+
+void Solver::ponder(const Board& board, std::chrono::microseconds budget) {
+    searchAnytime(board, budget);
+}
+
+SearchResult Solver::searchAnytime(const Board& board, std::chrono::microseconds budget) {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + budget;
+    std::vector<int> candidates = prepareSearch(board, statistics_, table_);
+    int roundsPlayed = 0;
+
+    // Small rounds until the deadline, dropping the moves that are clearly
+    // behind the leader. The deadline is checked between rounds, so it can
+    // be overrun by the duration of one batch of rollouts.
+    while (candidates.size() > 1) {
+        if (!runRound(board, statistics_, candidates, options_.numThreads * ANYTIME_BATCH_SIZE, nullptr)) {
+            break;
+        }
+        roundsPlayed++;
+
+        eliminateDominated(statistics_, candidates);
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+
+    return finishSearch(board, statistics_, candidates, roundsPlayed, start, table_);
+}
+
+// A batch smaller than the pool leaves workers idle, which is the price of
+// results that do not depend on the thread count
+std::vector<SearchResult> Solver::searchBatch(const Grid* grids, size_t count) {
+    std::vector<SearchResult> results(count);
+    // The generator of a board only depends on the seed, the batch and the
+    // board's index, and no board reads what another stored, so the results
+    // do not depend on the scheduling
+    uint64_t batchSeed = deriveSeed(options_.seed ^ BATCH_SEED_SALT, batchesSearched_++);
+    pool_.parallelFor(0, static_cast<int>(count), 1, [&](int i) {
+        Rng gen(deriveSeed(batchSeed, static_cast<uint64_t>(i)));
+        Statistics statistics;
+        Board start;
+        start.grid = grids[i];
+        results[i] = searchFixed(start, statistics, &gen, nullptr);
+    });
+    return results;
+}
+
+std::vector<SearchResult> Solver::searchBatch(const std::vector<Grid>& grids) {
+    return searchBatch(grids.data(), grids.size());
+}
+
+// A move the book gives for a position it cannot be played in means the book
+// was built for other rules, it is ignored rather than trusted
+bool Solver::probeBook(const Board& board, SearchResult& result) {
+    Move move;
+    float value;
+    if (options_.book == nullptr || !options_.book->probe(board.grid, move, value)
+        || !isMoveLegal(legalMoves(board.grid), move)) {
+        return false;
+    }
+
+    result.move = move;
+    result.values.fill(-std::numeric_limits<double>::infinity());
+    result.values[static_cast<int>(move)] = board.score + static_cast<double>(value);
+    result.rollouts.fill(0);
+    result.fromBook = true;
+    metrics_->add(Counter::BOOK_HITS);
+    return true;
+}
+
+std::vector<int> Solver::prepareSearch(const Board& board, Statistics& allStatistics, TranspositionTable* table) {
+    std::vector<int> candidates;
+
+    for (int j = 0; j < NUMBER_OF_MOVES; ++j) {
+        MoveStatistics& statistics = allStatistics[j];
+        statistics = MoveStatistics{ board, 0.0, 0.0, 0, 0, false };
+
+        // Illegal moves are pruned before any rollout
+        if (!applyMove(statistics.afterBoard, static_cast<Move>(j))) {
+            continue;
+        }
+        candidates.push_back(j);
+
+        if (table == nullptr) {
+            continue;
+        }
+
+        // Cached rollouts count as if they were played again, spread included,
+        // so that their standard error is the one they were stored with
+        TableEntry entry;
+        if (!table->probe(rolloutKey(statistics.afterBoard.grid, options_.canonicalKeys), entry)) {
+            metrics_->add(Counter::TABLE_MISSES);
+            continue;
+        }
+        metrics_->add(Counter::TABLE_HITS);
+        double cachedMean = statistics.afterBoard.score + static_cast<double>(entry.value);
+        statistics.total = cachedMean * entry.depth;
+        double spread = static_cast<double>(entry.spread);
+        statistics.totalSquares = (cachedMean * cachedMean + spread * spread) * entry.depth;
+        statistics.count = entry.depth;
+        statistics.frozen = entry.depth >= options_.numberOfSimulationsPerMove;
+    }
+
+    return candidates;
+}
+
+SearchResult Solver::finishSearch(const Board& board, const Statistics& allStatistics, const std::vector<int>& candidates,
+    int rounds, std::chrono::steady_clock::time_point start, TranspositionTable* table) {
+    SearchResult result;
+    double bestValue = -std::numeric_limits<double>::infinity();
+
+    for (int j = 0; j < NUMBER_OF_MOVES; ++j) {
+        const MoveStatistics& statistics = allStatistics[j];
+        bool legal = statistics.afterBoard.grid != board.grid;
+
+        result.values[j] = legal ? statistics.mean() : -std::numeric_limits<double>::infinity();
+        result.rollouts[j] = statistics.rollouts;
+
+        if (legal && statistics.rollouts > 0 && table != nullptr) {
+            uint16_t depth = static_cast<uint16_t>(std::min(statistics.count, UINT16_MAX - 1));
+            table->store(rolloutKey(statistics.afterBoard.grid, options_.canonicalKeys),
+                static_cast<float>(statistics.mean() - statistics.afterBoard.score), depth,
+                static_cast<float>(statistics.deviation()));
+        }
+    }
+
+    // Moves dropped during the search keep their means, only survivors may win
+    for (int j : candidates) {
+        if (result.values[j] > bestValue) {
+            bestValue = result.values[j];
+            result.move = static_cast<Move>(j);
+        }
+    }
+
+    result.rounds = rounds;
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+void Solver::recordDecision(const SearchResult& result) {
+    metrics_->add(Counter::DECISIONS);
+    metrics_->recordDecision(result.elapsed);
+}
+
+bool Solver::runRound(const Board& board, Statistics& statistics, const std::vector<int>& candidates, int rolloutsPerCandidate,
+    Rng* gen) {
+    int numThreads = options_.numThreads;
+    const RolloutOptions& rollout = options_.rollout;
+    bool batched = options_.batchedRollouts && rollout.policy == RolloutPolicy::UNIFORM
+        && rollout.depth >= DEPTH && rollout.evaluator == nullptr;
+    std::array<int, NUMBER_OF_MOVES> rolloutsPerMove = { 0, 0, 0, 0 };
+    bool anyRollout = false;
+
+    for (int j : candidates) {
+        if (!statistics[j].frozen) {
+            rolloutsPerMove[j] = rolloutsPerCandidate;
+            anyRollout = true;
+        }
+    }
+
+    if (!anyRollout) {
+        return false;
+    }
+
+    // Counted by the thread that played them, in its own cache line
+    auto play = [&](Move move, int share, Rng& generator) {
+        if (share == 0) {
+            return RolloutStats();
+        }
+        RolloutStats stats = batched ? runSimulationsBatched(board, move, share, generator)
+                                     : runSimulations(board, move, share, generator, rollout);
+        metrics_->add(Counter::ROLLOUTS, static_cast<uint64_t>(stats.count));
+        metrics_->add(Counter::MOVES, stats.moves);
+        return stats;
+    };
+
+    auto add = [&](MoveStatistics& moveStatistics, const RolloutStats& stats) {
+        moveStatistics.total += stats.total;
+        moveStatistics.totalSquares += stats.totalSquares;
+        moveStatistics.count += stats.count;
+        moveStatistics.rollouts += stats.count;
+        rolloutsPlayed_.fetch_add(static_cast<uint64_t>(stats.count), std::memory_order_relaxed);
+    };
+
+    if (gen != nullptr) {
+        for (int j : candidates) {
+            add(statistics[j], play(static_cast<Move>(j), rolloutsPerMove[j], *gen));
+        }
+        return true;
+    }
+
+    // Task t of move j plays its share of the move's rollouts, the remainder
+    // going to the first tasks so that no rollout is lost to the division
+    pool_.parallelFor(0, NUMBER_OF_MOVES * numThreads, 1, [&](int task) {
+        int j = task / numThreads;
+        int t = task % numThreads;
+        int share = rolloutsPerMove[j] / numThreads + (t < rolloutsPerMove[j] % numThreads ? 1 : 0);
+        taskStats_[task] = play(static_cast<Move>(j), share, generators_[task]);
+    });
+
+    for (int task = 0; task < NUMBER_OF_MOVES * numThreads; ++task) {
+        add(statistics[task / numThreads], taskStats_[task]);
+    }
+
+    return true;
+}
+
+void Solver::eliminateDominated(const Statistics& statistics, std::vector<int>& candidates) const {
+    int leader = candidates[0];
+    for (int j : candidates) {
+        if (statistics[j].mean() > statistics[leader].mean()) {
+            leader = j;
+        }
+    }
+
+    const MoveStatistics& best = statistics[leader];
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), [&](int j) {
+        const MoveStatistics& other = statistics[j];
+        double margin = options_.dominanceThreshold * std::hypot(best.standardError(), other.standardError());
+        return j != leader && best.mean() - other.mean() > margin;
+    }), candidates.end());
+}
+
+void Solver::newGame() {
+    if (table_ != nullptr) {
+        table_->clear();
+    }
+}
+
+void Solver::reseed(uint64_t seed) {
+    options_.seed = seed;
+    batchesSearched_ = 0;
+    for (size_t i = 0; i < generators_.size(); ++i) {
+        generators_[i] = Rng(deriveSeed(seed, i));
+    }
+}
+
+const SolverOptions& Solver::options() const {
+    return options_;
+}
+
+uint64_t Solver::rolloutsPlayed() const {
+    return rolloutsPlayed_.load(std::memory_order_relaxed);
+}
+
+TranspositionTable* Solver::table() {
+    return table_;
+}
+
+Metrics& Solver::metrics() {
+    return *metrics_;
+}
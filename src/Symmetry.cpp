@@ -0,0 +1,30 @@
+// Dihedral symmetries of the board and canonical grid keys
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "Symmetry.hpp"
+
+void symmetricGrids(Grid grid, Grid (&symmetries)[NUMBER_OF_SYMMETRIES]) {
+    Grid transposed = transposeGrid(grid);
+    symmetries[0] = grid;
+    symmetries[1] = mirrorGrid(grid);
+    symmetries[2] = flipGrid(grid);
+    symmetries[3] = mirrorGrid(symmetries[2]);
+    symmetries[4] = transposed;
+    symmetries[5] = mirrorGrid(transposed);
+    symmetries[6] = flipGrid(transposed);
+    symmetries[7] = mirrorGrid(symmetries[6]);
+}
+
+CanonicalGrid canonicalGrid(Grid grid) {
+    Grid symmetries[NUMBER_OF_SYMMETRIES];
+    symmetricGrids(grid, symmetries);
+
+    CanonicalGrid canonical{ grid, 0 };
+    for (int s = 1; s < NUMBER_OF_SYMMETRIES; ++s) {
+        if (symmetries[s] < canonical.key) {
+            canonical = CanonicalGrid{ symmetries[s], s };
+        }
+    }
+    return canonical;
+}
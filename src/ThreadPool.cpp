@@ -4,31 +4,258 @@
 
 #include "ThreadPool.hpp"
 
-ThreadPool::ThreadPool(size_t threads)
-    : stop(false) {
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pool and deque index of the worker running on the current thread
+static thread_local const ThreadPool* currentPool = nullptr;
+static thread_local int currentIndex = -1;
+
+ThreadPool::WorkStealingDeque::WorkStealingDeque()
+    : top(0), bottom(0), buffer(new std::atomic<Job*>[CAPACITY]) {
+    for (int64_t i = 0; i < CAPACITY; ++i)
+        buffer[i].store(nullptr, std::memory_order_relaxed);
+}
+
+bool ThreadPool::WorkStealingDeque::push(Job* job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY)
+        return false;
+
+    buffer[b & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+ThreadPool::Job* ThreadPool::WorkStealingDeque::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = buffer[b & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        // Last job, race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+ThreadPool::Job* ThreadPool::WorkStealingDeque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return nullptr;
+
+    Job* job = buffer[t & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+bool ThreadPool::WorkStealingDeque::empty() const {
+    int64_t b = bottom.load(std::memory_order_acquire);
+    int64_t t = top.load(std::memory_order_acquire);
+    return t >= b;
+}
+
+ThreadPool::ThreadPool(size_t threads, Metrics* metrics)
+    : injectedCount(0), sleepers(0), stop(false), metrics(metrics) {
+    for (size_t i = 0; i < threads; ++i)
+        deques.push_back(std::make_unique<WorkStealingDeque>());
+
     for (size_t i = 0; i < threads; ++i)
-        workers.emplace_back([this] {
-            for (;;) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(this->queue_mutex);
-                    this->condition.wait(lock, [this] { return this->stop || !this->tasks.empty(); });
-                    if (this->stop && this->tasks.empty())
-                        return;
-                    task = std::move(this->tasks.front());
-                    this->tasks.pop();
-                }
-                task();
+        workers.emplace_back([this, i] { workerLoop(static_cast<int>(i)); });
+}
+
+size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+int ThreadPool::currentWorker() const {
+    return onWorkerThread() ? currentIndex : -1;
+}
+
+bool ThreadPool::pinWorkers() {
+#ifdef __linux__
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return false;
+
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &allowed))
+            cpus.push_back(cpu);
+    if (cpus.empty())
+        return false;
+
+    bool pinned = true;
+    for (size_t i = 0; i < workers.size(); ++i) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[i % cpus.size()], &set);
+        if (pthread_setaffinity_np(workers[i].native_handle(), sizeof(set), &set) != 0)
+            pinned = false;
+    }
+    return pinned;
+#else
+    return false;
+#endif
+}
+
+bool ThreadPool::onWorkerThread() const {
+    return currentPool == this;
+}
+
+bool ThreadPool::pushLocal(Job* job) {
+    if (!deques[currentIndex]->push(job))
+        return false;
+
+    // Pairs with the fence in workerLoop so that either the sleeper sees the
+    // job or this thread sees the sleeper
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        condition.notify_one();
+    }
+    return true;
+}
+
+void ThreadPool::submit(Job* job) {
+    if (onWorkerThread() && pushLocal(job))
+        return;
+
+    if (metrics != nullptr)
+        job->queued = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        injected.push_back(job);
+        injectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        condition.notify_one();
+    }
+}
+
+ThreadPool::Job* ThreadPool::findJob(int index) {
+    Job* job = deques[index]->pop();
+    if (job != nullptr)
+        return job;
+
+    if (injectedCount.load(std::memory_order_relaxed) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (!injected.empty()) {
+                job = injected.front();
+                injected.pop_front();
+                injectedCount.fetch_sub(1, std::memory_order_relaxed);
             }
-        });
+        }
+        if (job != nullptr) {
+            if (metrics != nullptr)
+                metrics->recordQueueWait(std::chrono::steady_clock::now() - job->queued);
+            return job;
+        }
+    }
+
+    int numberOfDeques = static_cast<int>(deques.size());
+    for (int offset = 1; offset < numberOfDeques; ++offset) {
+        job = deques[(index + offset) % numberOfDeques]->steal();
+        if (job != nullptr)
+            return job;
+    }
+
+    return nullptr;
+}
+
+static uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+bool ThreadPool::hasWork() const {
+    if (injectedCount.load(std::memory_order_relaxed) > 0)
+        return true;
+
+    for (const std::unique_ptr<WorkStealingDeque>& deque : deques)
+        if (!deque->empty())
+            return true;
+
+    return false;
+}
+
+void ThreadPool::waitUntil(const std::atomic<bool>& done) {
+    while (!done.load(std::memory_order_acquire)) {
+        Job* job = findJob(currentIndex);
+        if (job != nullptr)
+            job->execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void ThreadPool::workerLoop(int index) {
+    currentPool = this;
+    currentIndex = index;
+
+    for (;;) {
+        Job* job = findJob(index);
+        if (job != nullptr) {
+            if (metrics == nullptr) {
+                job->execute(job);
+                continue;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            job->execute(job);
+            metrics->add(Counter::JOBS);
+            metrics->add(Counter::BUSY_NANOSECONDS, elapsedNanoseconds(start));
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (stop.load(std::memory_order_relaxed) && !hasWork()) {
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (!hasWork()) {
+            if (metrics == nullptr) {
+                condition.wait(lock);
+            } else {
+                auto start = std::chrono::steady_clock::now();
+                condition.wait(lock);
+                metrics->add(Counter::IDLE_NANOSECONDS, elapsedNanoseconds(start));
+            }
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
 }
 
 ThreadPool::~ThreadPool() {
     {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        stop.store(true, std::memory_order_relaxed);
     }
     condition.notify_all();
     for (std::thread& worker : workers)
         worker.join();
-}
\ No newline at end of file
+}
@@ -0,0 +1,267 @@
+// Compact binary log of the plies played by the solver
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include "TrajectoryLog.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+static_assert(sizeof(Grid) == 8 && sizeof(float) == 4, "the log stores 64-bit grids and 32-bit floats");
+
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t CHUNK_HEADER_SIZE = 16;
+constexpr size_t INDEX_ENTRY_SIZE = 24;
+constexpr size_t FOOTER_SIZE = 24;
+
+static size_t padTo8(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+
+uint8_t packPly(Move move, int spawnCell, bool fourTile) {
+    return static_cast<uint8_t>(static_cast<int>(move) | (spawnCell << 2) | (fourTile ? 0x40 : 0) | 0x80);
+}
+
+uint8_t packPly(Grid before, Move move, Grid after) {
+    uint32_t unusedScore = 0;
+    Grid spawn = after ^ moveGrid(before, move, unusedScore);
+    if (spawn == 0) {
+        return static_cast<uint8_t>(move);
+    }
+
+    int cell = __builtin_ctzll(spawn) / 4;
+    return packPly(move, cell, (spawn >> (cell * 4)) == 2);
+}
+
+GameTrajectory::GameTrajectory(uint64_t gameId)
+    : gameId_(gameId) {
+}
+
+void GameTrajectory::append(Grid before, Move move, Grid after) {
+    grids_.push_back(before);
+    packed_.push_back(packPly(before, move, after));
+    scores_.insert(scores_.end(), NUMBER_OF_MOVES, std::numeric_limits<float>::quiet_NaN());
+}
+
+void GameTrajectory::append(Grid before, Move move, Grid after, const std::array<double, NUMBER_OF_MOVES>& scores) {
+    grids_.push_back(before);
+    packed_.push_back(packPly(before, move, after));
+    for (double score : scores) {
+        scores_.push_back(static_cast<float>(score));
+    }
+}
+
+void GameTrajectory::clear(uint64_t gameId) {
+    gameId_ = gameId;
+    grids_.clear();
+    packed_.clear();
+    scores_.clear();
+}
+
+uint64_t GameTrajectory::gameId() const {
+    return gameId_;
+}
+
+size_t GameTrajectory::size() const {
+    return grids_.size();
+}
+
+TrajectoryWriter::TrajectoryWriter(const std::string& path, bool withScores)
+    : file_(std::fopen(path.c_str(), "wb")), withScores_(withScores), offset_(0) {
+    if (file_ == nullptr) {
+        throw std::runtime_error("cannot create trajectory log " + path);
+    }
+
+    uint32_t header[2] = { TRAJECTORY_VERSION, withScores_ ? TRAJECTORY_HAS_SCORES : 0 };
+    writeBytes(TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC));
+    writeBytes(header, sizeof(header));
+}
+
+TrajectoryWriter::~TrajectoryWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // The chunks already written stay readable without the index
+    }
+}
+
+void TrajectoryWriter::writeBytes(const void* data, size_t size) {
+    if (std::fwrite(data, 1, size, file_) != size) {
+        throw std::runtime_error("cannot write trajectory log");
+    }
+    offset_ += size;
+}
+
+void TrajectoryWriter::write(const GameTrajectory& game) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr) {
+        throw std::runtime_error("write on closed trajectory log");
+    }
+
+    IndexEntry entry = { offset_, static_cast<uint32_t>(game.size()), 0, game.gameId_ };
+    uint32_t chunkHeader[2] = { entry.plies, 0 };
+    writeBytes(chunkHeader, sizeof(chunkHeader));
+    writeBytes(&entry.gameId, sizeof(entry.gameId));
+    writeBytes(game.grids_.data(), game.grids_.size() * sizeof(Grid));
+    if (withScores_) {
+        writeBytes(game.scores_.data(), game.scores_.size() * sizeof(float));
+    }
+    writeBytes(game.packed_.data(), game.packed_.size());
+
+    static const char padding[8] = {};
+    writeBytes(padding, padTo8(offset_) - offset_);
+    index_.push_back(entry);
+}
+
+void TrajectoryWriter::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_ == nullptr) {
+        return;
+    }
+
+    uint64_t indexOffset = offset_;
+    for (const IndexEntry& entry : index_) {
+        writeBytes(&entry.offset, sizeof(entry.offset));
+        writeBytes(&entry.plies, sizeof(entry.plies));
+        writeBytes(&entry.reserved, sizeof(entry.reserved));
+        writeBytes(&entry.gameId, sizeof(entry.gameId));
+    }
+
+    uint64_t numberOfGames = index_.size();
+    writeBytes(&indexOffset, sizeof(indexOffset));
+    writeBytes(&numberOfGames, sizeof(numberOfGames));
+    writeBytes(TRAJECTORY_INDEX_MAGIC, sizeof(TRAJECTORY_INDEX_MAGIC));
+
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+GameView::GameView(uint64_t gameId, size_t plies, const Grid* grids, const uint8_t* packed, const float* scores)
+    : gameId_(gameId), plies_(plies), grids_(grids), packed_(packed), scores_(scores) {
+}
+
+uint64_t GameView::gameId() const {
+    return gameId_;
+}
+
+size_t GameView::size() const {
+    return plies_;
+}
+
+Ply GameView::operator[](size_t index) const {
+    return Ply{ grids_[index], packed_[index], scores_ != nullptr ? scores_ + index * NUMBER_OF_MOVES : nullptr };
+}
+
+GameView::Iterator GameView::begin() const {
+    return Iterator(this, 0);
+}
+
+GameView::Iterator GameView::end() const {
+    return Iterator(this, plies_);
+}
+
+const Grid* GameView::grids() const {
+    return grids_;
+}
+
+const uint8_t* GameView::packed() const {
+    return packed_;
+}
+
+const float* GameView::scores() const {
+    return scores_;
+}
+
+TrajectoryReader::TrajectoryReader(const std::string& path)
+    : mapping_(path), data_(mapping_.data()), size_(mapping_.size()), withScores_(false) {
+    uint32_t header[2];
+    if (size_ < HEADER_SIZE || std::memcmp(data_, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC)) != 0) {
+        throw std::runtime_error("invalid trajectory log " + path);
+    }
+    std::memcpy(header, data_ + sizeof(TRAJECTORY_MAGIC), sizeof(header));
+    if (header[0] != TRAJECTORY_VERSION) {
+        throw std::runtime_error("invalid trajectory log " + path);
+    }
+    withScores_ = (header[1] & TRAJECTORY_HAS_SCORES) != 0;
+
+    if (size_ >= HEADER_SIZE + FOOTER_SIZE
+        && std::memcmp(data_ + size_ - sizeof(TRAJECTORY_INDEX_MAGIC), TRAJECTORY_INDEX_MAGIC, sizeof(TRAJECTORY_INDEX_MAGIC)) == 0) {
+        readIndex();
+    } else {
+        scanChunks();
+    }
+}
+
+size_t TrajectoryReader::chunkSize(size_t plies) const {
+    return padTo8(CHUNK_HEADER_SIZE + plies * (sizeof(Grid) + 1 + (withScores_ ? NUMBER_OF_MOVES * sizeof(float) : 0)));
+}
+
+void TrajectoryReader::readIndex() {
+    uint64_t indexOffset;
+    uint64_t numberOfGames;
+    std::memcpy(&indexOffset, data_ + size_ - FOOTER_SIZE, sizeof(indexOffset));
+    std::memcpy(&numberOfGames, data_ + size_ - FOOTER_SIZE + 8, sizeof(numberOfGames));
+    if (indexOffset > size_ - FOOTER_SIZE || numberOfGames != (size_ - FOOTER_SIZE - indexOffset) / INDEX_ENTRY_SIZE) {
+        throw std::runtime_error("corrupted trajectory log index");
+    }
+
+    for (uint64_t i = 0; i < numberOfGames; ++i) {
+        const unsigned char* entry = data_ + indexOffset + i * INDEX_ENTRY_SIZE;
+        uint64_t offset;
+        uint32_t plies;
+        uint64_t gameId;
+        std::memcpy(&offset, entry, sizeof(offset));
+        std::memcpy(&plies, entry + 8, sizeof(plies));
+        std::memcpy(&gameId, entry + 16, sizeof(gameId));
+        // Subtracted rather than added, an offset read from the file may be
+        // anything and the sum could wrap around
+        if (offset % 8 != 0 || offset < HEADER_SIZE || offset > indexOffset || chunkSize(plies) > indexOffset - offset) {
+            throw std::runtime_error("corrupted trajectory log index");
+        }
+        chunks_.push_back(Chunk{ offset, plies, gameId });
+    }
+}
+
+// Recovers the complete chunks of a log whose writer did not close it
+void TrajectoryReader::scanChunks() {
+    uint64_t offset = HEADER_SIZE;
+    while (offset + CHUNK_HEADER_SIZE <= size_) {
+        uint32_t plies;
+        uint64_t gameId;
+        std::memcpy(&plies, data_ + offset, sizeof(plies));
+        std::memcpy(&gameId, data_ + offset + 8, sizeof(gameId));
+        if (offset + chunkSize(plies) > size_) {
+            break;
+        }
+        chunks_.push_back(Chunk{ offset, plies, gameId });
+        offset += chunkSize(plies);
+    }
+}
+
+bool TrajectoryReader::hasScores() const {
+    return withScores_;
+}
+
+size_t TrajectoryReader::numberOfGames() const {
+    return chunks_.size();
+}
+
+size_t TrajectoryReader::numberOfPlies() const {
+    size_t plies = 0;
+    for (const Chunk& chunk : chunks_) {
+        plies += chunk.plies;
+    }
+    return plies;
+}
+
+GameView TrajectoryReader::game(size_t index) const {
+    const Chunk& chunk = chunks_.at(index);
+    const unsigned char* grids = data_ + chunk.offset + CHUNK_HEADER_SIZE;
+    const unsigned char* scores = grids + chunk.plies * sizeof(Grid);
+    const unsigned char* packed = scores + (withScores_ ? chunk.plies * NUMBER_OF_MOVES * sizeof(float) : 0);
+
+    return GameView(chunk.gameId, chunk.plies,
+        reinterpret_cast<const Grid*>(grids),
+        packed,
+        withScores_ ? reinterpret_cast<const float*>(scores) : nullptr);
+}
@@ -0,0 +1,159 @@
+// Transposition table caching search results across moves
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <algorithm>
+#include <cstring>
+
+#include "TranspositionTable.hpp"
+
+// Data layout: value as a float in the low 32 bits, depth + 1 in the next 16 so
+// that an occupied slot never holds zero data, and the spread in the top 16 as
+// the high half of a float, rounded up so that it is never understated
+static uint64_t packEntry(float value, uint16_t depth, float spread) {
+    depth = std::min<uint16_t>(depth, UINT16_MAX - 1);
+    uint32_t valueBits;
+    std::memcpy(&valueBits, &value, sizeof(valueBits));
+    spread = std::max(0.0f, spread);
+    uint32_t spreadBits;
+    std::memcpy(&spreadBits, &spread, sizeof(spreadBits));
+    uint64_t spreadHigh = std::min<uint64_t>((static_cast<uint64_t>(spreadBits) + 0xFFFF) >> 16, 0x7F80);
+    return static_cast<uint64_t>(valueBits) | (static_cast<uint64_t>(depth + 1) << 32) | (spreadHigh << 48);
+}
+
+static TableEntry unpackEntry(uint64_t data) {
+    TableEntry entry;
+    uint32_t valueBits = static_cast<uint32_t>(data);
+    std::memcpy(&entry.value, &valueBits, sizeof(valueBits));
+    entry.depth = static_cast<uint16_t>(((data >> 32) & 0xFFFF) - 1);
+    uint32_t spreadBits = static_cast<uint32_t>(data >> 48) << 16;
+    std::memcpy(&entry.spread, &spreadBits, sizeof(spreadBits));
+    return entry;
+}
+
+static uint16_t storedDepth(uint64_t data) {
+    return static_cast<uint16_t>(((data >> 32) & 0xFFFF) - 1);
+}
+
+TranspositionTable::TranspositionTable(size_t sizeInMegabytes, Replacement replacement)
+    : numberOfBuckets_(1), indexShift_(64), replacement_(replacement) {
+    size_t maxBuckets = (sizeInMegabytes << 20) / sizeof(Bucket);
+    while (numberOfBuckets_ * 2 <= maxBuckets) {
+        numberOfBuckets_ *= 2;
+    }
+    for (size_t n = numberOfBuckets_; n > 1; n >>= 1) {
+        indexShift_--;
+    }
+
+    buckets_ = std::make_unique<Bucket[]>(numberOfBuckets_);
+    clear();
+    resetCounters();
+}
+
+size_t TranspositionTable::bucketIndex(Grid key) const {
+    if (indexShift_ == 64) {
+        return 0;
+    }
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> indexShift_);
+}
+
+bool TranspositionTable::probe(Grid key, TableEntry& entry) {
+    size_t index = bucketIndex(key);
+    Bucket& bucket = buckets_[index];
+    Counters& counters = counters_[index % COUNTER_STRIPES];
+
+    for (Slot& slot : bucket.entries) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        if (data != 0 && (check ^ data) == key) {
+            entry = unpackEntry(data);
+            counters.hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    counters.misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void TranspositionTable::store(Grid key, float value, uint16_t depth, float spread) {
+    Bucket& bucket = buckets_[bucketIndex(key)];
+
+    Slot* sameKey = nullptr;
+    Slot* empty = nullptr;
+    Slot* shallowest = nullptr;
+    uint16_t sameKeyDepth = 0;
+    uint16_t shallowestDepth = 0;
+
+    for (Slot& slot : bucket.entries) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        if (data == 0) {
+            if (empty == nullptr) {
+                empty = &slot;
+            }
+        } else if ((check ^ data) == key) {
+            sameKey = &slot;
+            sameKeyDepth = storedDepth(data);
+            break;
+        } else if (shallowest == nullptr || storedDepth(data) < shallowestDepth) {
+            shallowest = &slot;
+            shallowestDepth = storedDepth(data);
+        }
+    }
+
+    bool depthPreferred = replacement_ == Replacement::DEPTH_PREFERRED;
+    Slot* victim;
+
+    if (sameKey != nullptr) {
+        if (depthPreferred && sameKeyDepth > depth) {
+            return;
+        }
+        victim = sameKey;
+    } else if (empty != nullptr) {
+        victim = empty;
+    } else {
+        if (depthPreferred && shallowestDepth > depth) {
+            return;
+        }
+        victim = shallowest;
+    }
+
+    uint64_t data = packEntry(value, depth, spread);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < numberOfBuckets_; ++i) {
+        for (Slot& slot : buckets_[i].entries) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+uint64_t TranspositionTable::hits() const {
+    uint64_t total = 0;
+    for (const Counters& counters : counters_) {
+        total += counters.hits.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t TranspositionTable::misses() const {
+    uint64_t total = 0;
+    for (const Counters& counters : counters_) {
+        total += counters.misses.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void TranspositionTable::resetCounters() {
+    for (Counters& counters : counters_) {
+        counters.hits.store(0, std::memory_order_relaxed);
+        counters.misses.store(0, std::memory_order_relaxed);
+    }
+}
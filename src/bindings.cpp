@@ -2,8 +2,14 @@
 // Author: Fabrice Renard
 // Date : 30 / 08 / 2024
 
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <optional>
 #include "Game.hpp"
+#include "Solver.hpp"
+#include "Symmetry.hpp"
+#include "TrajectoryLog.hpp"
 
 namespace py = pybind11;
 
@@ -15,8 +21,18 @@ PYBIND11_MODULE(game_bindings, m) {
         .value("DOWN", Move::DOWN)
         .export_values();
 
+    m.def("legal_moves", &legalMoves, py::arg("grid"), "Bit m set if Move m changes the grid");
+    m.def("canonical_grid", [](Grid grid) {
+        CanonicalGrid canonical = canonicalGrid(grid);
+        return py::make_tuple(canonical.key, canonical.symmetry);
+    }, py::arg("grid"), "Smallest symmetric grid and the symmetry producing it");
+    m.def("apply_symmetry", &applySymmetry, py::arg("grid"), py::arg("symmetry"));
+    m.def("inverse_symmetry", &inverseSymmetry, py::arg("symmetry"));
+    m.def("symmetric_move", &symmetricMove, py::arg("move"), py::arg("symmetry"));
+
     py::class_<Game, std::shared_ptr<Game>>(m, "Game")
         .def(py::init<>())
+        .def(py::init<uint64_t>())
         .def(py::init<const Game&>())
         .def("add_tile", &Game::addTile)
         .def("move_left", &Game::moveLeft)
@@ -24,16 +40,13 @@ PYBIND11_MODULE(game_bindings, m) {
         .def("move_up", &Game::moveUp)
         .def("move_down", &Game::moveDown)
         .def("make_move", &Game::makeMove)
-        .def("merge", &Game::merge)
-        .def("compress", &Game::compress)
-        .def("flip", &Game::flip)
-        .def("transpose", &Game::transpose)
         .def("handle_key_press", &Game::handleKeyPress)
         .def("get_score", &Game::getScore)
         .def("get_grid", &Game::getGrid)
         .def("set_grid", &Game::setGrid)
         .def("reached_2048", &Game::reached2048)
         .def("is_game_over", &Game::isGameOver)
+        .def("legal_moves", &Game::legalMoves)
         .def("__eq__", &Game::operator==)
         .def("__repr__",
              [](const Game &a) {
@@ -41,4 +54,92 @@ PYBIND11_MODULE(game_bindings, m) {
                  oss << a;
                  return oss.str();
              });
+
+    py::class_<GameTrajectory>(m, "GameTrajectory")
+        .def(py::init<uint64_t>(), py::arg("game_id") = 0)
+        .def("append", py::overload_cast<Grid, Move, Grid>(&GameTrajectory::append))
+        .def("append", py::overload_cast<Grid, Move, Grid, const std::array<double, NUMBER_OF_MOVES>&>(&GameTrajectory::append))
+        .def("clear", &GameTrajectory::clear)
+        .def_property_readonly("game_id", &GameTrajectory::gameId)
+        .def("__len__", &GameTrajectory::size);
+
+    py::class_<TrajectoryWriter>(m, "TrajectoryWriter")
+        .def(py::init<const std::string&, bool>(), py::arg("path"), py::arg("with_scores") = false)
+        .def("write", &TrajectoryWriter::write)
+        .def("close", &TrajectoryWriter::close);
+
+    // The arrays are views on the mapping, each one keeps its game alive and
+    // every game keeps its reader alive
+    py::class_<GameView>(m, "GameView")
+        .def_property_readonly("game_id", &GameView::gameId)
+        .def("__len__", &GameView::size)
+        .def_property_readonly("grids", [](py::object self) {
+            const GameView& game = self.cast<const GameView&>();
+            return py::array_t<uint64_t>({ game.size() }, { sizeof(Grid) }, game.grids(), self);
+        })
+        .def_property_readonly("packed", [](py::object self) {
+            const GameView& game = self.cast<const GameView&>();
+            return py::array_t<uint8_t>({ game.size() }, { sizeof(uint8_t) }, game.packed(), self);
+        })
+        .def_property_readonly("moves", [](const GameView& game) {
+            py::array_t<uint8_t> moves(game.size());
+            for (size_t i = 0; i < game.size(); ++i) {
+                moves.mutable_at(i) = game.packed()[i] & 0x3;
+            }
+            return moves;
+        })
+        .def_property_readonly("scores", [](py::object self) -> py::object {
+            const GameView& game = self.cast<const GameView&>();
+            if (game.scores() == nullptr) {
+                return py::none();
+            }
+            return py::array_t<float>({ game.size(), static_cast<size_t>(NUMBER_OF_MOVES) },
+                { NUMBER_OF_MOVES * sizeof(float), sizeof(float) }, game.scores(), self);
+        });
+
+    // Searches many positions per call, the GIL is released while the pool
+    // searches so that other Python threads keep running
+    py::class_<Solver>(m, "Solver")
+        .def(py::init([](int simulations, int threads, std::optional<uint64_t> seed, size_t tableMegabytes) {
+            SolverOptions options;
+            options.numberOfSimulationsPerMove = simulations;
+            options.numThreads = threads > 0 ? threads : options.numThreads;
+            options.seed = seed ? *seed : randomSeed();
+            options.tableSizeInMegabytes = tableMegabytes;
+            return std::make_unique<Solver>(options);
+        }), py::arg("simulations") = NUMBER_OF_SIMULATIONS_PER_MOVE, py::arg("threads") = 0, py::arg("seed") = py::none(),
+            py::arg("table_mb") = TRANSPOSITION_TABLE_SIZE_MB)
+        .def("best_move", py::overload_cast<Grid>(&Solver::bestMove), py::arg("grid"), py::call_guard<py::gil_scoped_release>())
+        .def("search_batch", [](Solver& solver, py::array_t<uint64_t, py::array::c_style | py::array::forcecast> grids) {
+            std::vector<SearchResult> results;
+            {
+                py::gil_scoped_release release;
+                results = solver.searchBatch(grids.data(), static_cast<size_t>(grids.size()));
+            }
+
+            py::array_t<uint8_t> moves(results.size());
+            py::array_t<double> values({ results.size(), static_cast<size_t>(NUMBER_OF_MOVES) });
+            for (size_t i = 0; i < results.size(); ++i) {
+                moves.mutable_at(i) = static_cast<uint8_t>(results[i].move);
+                for (int j = 0; j < NUMBER_OF_MOVES; ++j) {
+                    values.mutable_at(i, j) = results[i].values[j];
+                }
+            }
+            return py::make_tuple(moves, values);
+        }, py::arg("grids"), "Best move of every grid and the value of each move, -inf if illegal. Batches skip the "
+            "table, so their results do not depend on the thread count")
+        .def("new_game", &Solver::newGame)
+        .def("reseed", &Solver::reseed, py::arg("seed"))
+        .def_property_readonly("rollouts_played", &Solver::rolloutsPlayed)
+        .def("metrics_json", [](Solver& solver) {
+            return solver.metrics().snapshot().toJson();
+        });
+
+    py::class_<TrajectoryReader>(m, "TrajectoryReader")
+        .def(py::init<const std::string&>())
+        .def_property_readonly("has_scores", &TrajectoryReader::hasScores)
+        .def_property_readonly("number_of_plies", &TrajectoryReader::numberOfPlies)
+        .def("__len__", &TrajectoryReader::numberOfGames)
+        .def("__getitem__", &TrajectoryReader::game, py::keep_alive<0, 1>())
+        .def("game", &TrajectoryReader::game, py::keep_alive<0, 1>());
 }
@@ -0,0 +1,228 @@
+// Offline generator of the opening book
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Board.hpp"
+#include "OpeningBook.hpp"
+#include "Policy.hpp"
+#include "Random.hpp"
+#include "Symmetry.hpp"
+
+struct BookOptions {
+    int games = 1000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 2048;
+    // Plays the games the positions are collected from
+    Engine engine = Engine::MONTE_CARLO;
+    // Positions whose tiles add up to at most this are collected
+    int maxTileSum = 64;
+    // Positions reached in fewer games are left out
+    int minCount = 2;
+    // 0 keeps every position reached often enough, otherwise the most frequent
+    size_t maxPositions = 0;
+    // Rollouts per move of the search deciding each book move
+    int simulations = 3000;
+    // Leaf evaluator of both searches, heuristic or an n-tuple network path
+    std::string evaluator;
+    std::string output = "book.bin";
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --games N          games played to collect positions (1000)\n"
+              << "  --threads N        games and searches run in parallel (hardware threads)\n"
+              << "  --seed N           base seed (2048)\n"
+              << "  --engine NAME      mc, mcts or expectimax, plays the collection games (mc)\n"
+              << "  --max-sum N        collect positions whose tiles sum to at most N (64)\n"
+              << "  --min-count N      keep positions reached in at least N games (2)\n"
+              << "  --max-positions N  keep only the N most frequent positions, 0 for all (0)\n"
+              << "  --sims N           rollouts per move when solving a position (3000)\n"
+              << "  --evaluator NAME   heuristic or an n-tuple network path\n"
+              << "  --output PATH      book written at the end (book.bin)\n";
+}
+
+static bool parseOptions(int argc, char* argv[], BookOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h" || i + 1 == argc) {
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (flag == "--games") {
+            options.games = std::atoi(value.c_str());
+        } else if (flag == "--threads") {
+            options.threads = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--engine") {
+            if (!parseEngine(value, options.engine)) {
+                std::cerr << "Unknown engine " << value << "\n";
+                return false;
+            }
+        } else if (flag == "--max-sum") {
+            options.maxTileSum = std::atoi(value.c_str());
+        } else if (flag == "--min-count") {
+            options.minCount = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--max-positions") {
+            options.maxPositions = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--sims") {
+            options.simulations = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--evaluator") {
+            options.evaluator = value;
+        } else if (flag == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static int tileSum(Grid grid) {
+    int sum = 0;
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; ++i) {
+        int exponent = (grid >> (i * 4)) & 0xF;
+        sum += exponent > 0 ? 1 << exponent : 0;
+    }
+    return sum;
+}
+
+using PositionCounts = std::unordered_map<Grid, int>;
+
+// Every spawn raises the tile sum, so a game never meets a position twice and
+// is stopped as soon as it leaves the range of the book
+static void collectPositions(Policy& policy, const BookOptions& options, int index, PositionCounts& counts) {
+    uint64_t gameSeed = deriveSeed(options.seed, static_cast<uint64_t>(index));
+    Rng gen(deriveSeed(gameSeed, 0));
+    policy.newGame();
+    policy.reseed(deriveSeed(gameSeed, 1));
+
+    Board board = newBoard(gen);
+    while (!isGameOver(board.grid) && tileSum(board.grid) <= options.maxTileSum) {
+        ++counts[canonicalKey(board.grid)];
+        Move bestMove = policy.bestMove(board);
+        if (!playMove(board, bestMove, gen)) {
+            playMove(board, static_cast<Move>(__builtin_ctz(legalMoves(board.grid))), gen);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BookOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::shared_ptr<const Evaluator> evaluator;
+    if (!options.evaluator.empty()) {
+        try {
+            evaluator = makeEvaluator(options.evaluator);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << "\n";
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::atomic<int> nextGame(0);
+    std::mutex countsMutex;
+    PositionCounts counts;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < options.threads; ++t) {
+        threads.emplace_back([&] {
+            std::unique_ptr<Policy> policy = makePolicy(options.engine, 1, evaluator);
+            PositionCounts local;
+            for (int index = nextGame++; index < options.games; index = nextGame++) {
+                collectPositions(*policy, options, index, local);
+            }
+
+            std::lock_guard<std::mutex> lock(countsMutex);
+            for (const auto& position : local) {
+                counts[position.first] += position.second;
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    // Most frequent first, ties broken by key so that the book does not
+    // depend on the thread count. A position with a single legal move needs
+    // no book, and its search plays no rollout to value it with
+    std::vector<std::pair<Grid, int>> positions;
+    for (const auto& position : counts) {
+        if (position.second >= options.minCount && __builtin_popcount(legalMoves(position.first)) > 1) {
+            positions.push_back(position);
+        }
+    }
+    std::sort(positions.begin(), positions.end(), [](const std::pair<Grid, int>& left, const std::pair<Grid, int>& right) {
+        return left.second != right.second ? left.second > right.second : left.first < right.first;
+    });
+    if (options.maxPositions > 0 && positions.size() > options.maxPositions) {
+        positions.resize(options.maxPositions);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%zu distinct positions in %d games, %zu kept, %.2f s\n",
+        counts.size(), options.games, positions.size(), seconds);
+
+    // Each position is solved from a score of 0, the value of its move is then
+    // the score expected to be gained from there
+    std::atomic<size_t> nextPosition(0);
+    std::atomic<size_t> solved(0);
+    std::vector<BookEntry> entries(positions.size());
+    size_t reportEvery = std::max<size_t>(1, positions.size() / 10);
+    for (int t = 0; t < options.threads; ++t) {
+        threads.emplace_back([&, t] {
+            SolverOptions solverOptions = monteCarloOptions(1, evaluator.get());
+            solverOptions.numberOfSimulationsPerMove = options.simulations;
+            solverOptions.seed = deriveSeed(options.seed, static_cast<uint64_t>(options.games + t));
+            solverOptions.tableSizeInMegabytes = 0;
+            Solver solver(solverOptions);
+
+            for (size_t i = nextPosition++; i < positions.size(); i = nextPosition++) {
+                Board board;
+                board.grid = positions[i].first;
+                solver.reseed(deriveSeed(options.seed, positions[i].first));
+                SearchResult result = solver.search(board);
+
+                entries[i] = BookEntry{ board.grid, static_cast<float>(result.values[static_cast<int>(result.move)]),
+                    static_cast<uint32_t>(result.move) };
+                size_t done = ++solved;
+                if (done % reportEvery == 0) {
+                    std::fprintf(stderr, "%zu/%zu positions solved\n", done, positions.size());
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    try {
+        OpeningBook::write(options.output, std::move(entries));
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "book of %zu positions written to %s in %.2f s\n", positions.size(), options.output.c_str(), seconds);
+    return 0;
+}
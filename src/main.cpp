@@ -4,15 +4,47 @@
 
 #include "GameWindow.hpp"
 #include <QtWidgets/QApplication>
+#include <cstring>
+#include <thread>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // The search engine is chosen per deployment with --engine <mc|mcts|expectimax>,
+    // --evaluator <heuristic|network path> sets the leaf evaluator of the
+    // engines using one and --book <path> an opening book
+    Engine engine = Engine::MONTE_CARLO;
+    std::shared_ptr<const Evaluator> evaluator;
+    std::shared_ptr<const OpeningBook> book;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--engine") == 0 && !parseEngine(argv[i + 1], engine)) {
+            qWarning() << "Unknown engine" << argv[i + 1] << ", using Monte Carlo";
+        }
+        if (std::strcmp(argv[i], "--evaluator") == 0) {
+            try {
+                evaluator = makeEvaluator(argv[i + 1]);
+            } catch (const std::exception& error) {
+                qWarning() << error.what() << ", playing without an evaluator";
+            }
+        }
+        if (std::strcmp(argv[i], "--book") == 0) {
+            try {
+                book = OpeningBook::load(argv[i + 1]);
+            } catch (const std::exception& error) {
+                qWarning() << error.what() << ", playing without a book";
+            }
+        }
+    }
+
+    std::shared_ptr<Policy> policy = makePolicy(engine, std::thread::hardware_concurrency(), evaluator, book);
     std::shared_ptr<Game> game = std::make_shared<Game>();
-    GameWindow w(nullptr, game, true);
+    // Monte Carlo and expectimax keep their caches across positions, pondering
+    // fills them. MCTS would lose the subtree it keeps for the next move
+    GameWindow w(nullptr, game, policy, true, engine != Engine::MCTS);
 
     QObject::connect(&w, &GameWindow::keyPressed, game.get(), &Game::handleKeyPress);
 
     w.show();
     return a.exec();
-}
\ No newline at end of file
+}
@@ -0,0 +1,348 @@
+// Headless self-play runner playing many games in parallel
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.hpp"
+#include "Metrics.hpp"
+#include "Policy.hpp"
+#include "Random.hpp"
+#include "TrajectoryLog.hpp"
+
+enum class OutputFormat { CSV = 0, JSONL = 1 };
+
+struct SelfPlayOptions {
+    int games = 100;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 2048;
+    Engine engine = Engine::MONTE_CARLO;
+    int simulations = NUMBER_OF_SIMULATIONS_PER_MOVE;
+    // 0 plays a fixed number of rollouts per move instead of a time budget
+    int budgetMicroseconds = 0;
+    size_t tableSizeInMegabytes = 16;
+    OutputFormat format = OutputFormat::CSV;
+    std::string output = "-";
+    // Binary log of every ply, empty to skip it
+    std::string trajectories;
+    // Scores the leaves of the searches, heuristic or an n-tuple network
+    // path, empty for none
+    std::string evaluator;
+    // Opening book checked before every search, empty for none
+    std::string book;
+    // Metrics of the Monte Carlo solvers written at the end, empty to skip
+    std::string metrics;
+};
+
+struct GameResult {
+    int index;
+    uint64_t seed;
+    Grid grid;
+    int score;
+    int maxTile;
+    int moves;
+    uint64_t rollouts;
+    double milliseconds;
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --games N          number of games to play (100)\n"
+              << "  --threads N        games played in parallel (hardware threads)\n"
+              << "  --seed N           base seed, game i always gets the same seeds (2048)\n"
+              << "  --engine NAME      mc, mcts or expectimax (mc)\n"
+              << "  --sims N           Monte Carlo rollouts per move (" << NUMBER_OF_SIMULATIONS_PER_MOVE << ")\n"
+              << "  --budget-us N      time budget per move instead of a fixed rollout count\n"
+              << "  --table-mb N       transposition table size per game thread, mc and expectimax (16)\n"
+              << "  --format FORMAT    csv or jsonl (csv)\n"
+              << "  --output PATH      results file, - for stdout (-)\n"
+              << "  --trajectories PATH binary log of every ply played\n"
+              << "  --evaluator NAME   leaf evaluator, heuristic or an n-tuple network path, mc then plays short greedy rollouts\n"
+              << "  --book PATH        opening book answering the positions it holds\n"
+              << "  --metrics PATH     Monte Carlo solver metrics, Prometheus text if PATH ends in .prom, JSON otherwise\n";
+}
+
+static bool parseOptions(int argc, char* argv[], SelfPlayOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h" || i + 1 == argc) {
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (flag == "--games") {
+            options.games = std::atoi(value.c_str());
+        } else if (flag == "--threads") {
+            options.threads = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--engine") {
+            if (!parseEngine(value, options.engine)) {
+                std::cerr << "Unknown engine " << value << "\n";
+                return false;
+            }
+        } else if (flag == "--sims") {
+            options.simulations = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--budget-us") {
+            options.budgetMicroseconds = std::max(0, std::atoi(value.c_str()));
+        } else if (flag == "--table-mb") {
+            options.tableSizeInMegabytes = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--format") {
+            if (value == "csv") {
+                options.format = OutputFormat::CSV;
+            } else if (value == "jsonl") {
+                options.format = OutputFormat::JSONL;
+            } else {
+                std::cerr << "Unknown format " << value << "\n";
+                return false;
+            }
+        } else if (flag == "--output") {
+            options.output = value;
+        } else if (flag == "--trajectories") {
+            options.trajectories = value;
+        } else if (flag == "--evaluator") {
+            options.evaluator = value;
+        } else if (flag == "--book") {
+            options.book = value;
+        } else if (flag == "--metrics") {
+            options.metrics = value;
+        } else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every game thread searches on a single worker, the parallelism comes from
+// playing several games at once
+static std::unique_ptr<Policy> makeSelfPlayPolicy(const SelfPlayOptions& options, std::shared_ptr<const Evaluator> evaluator,
+    std::shared_ptr<const OpeningBook> book, Metrics* metrics) {
+    if (options.engine == Engine::EXPECTIMAX) {
+        return std::make_unique<ExpectimaxPolicy>(ExpectimaxOptions(), evaluator, book, options.tableSizeInMegabytes);
+    }
+    if (options.engine == Engine::MCTS) {
+        // The same number of rollouts per move as flat Monte Carlo
+        MctsOptions mctsOptions;
+        mctsOptions.iterations = options.simulations * NUMBER_OF_MOVES;
+        mctsOptions.numThreads = 1;
+        mctsOptions.seed = options.seed;
+        mctsOptions.rollout = monteCarloOptions(1, evaluator.get()).rollout;
+        return std::make_unique<MctsPolicy>(mctsOptions, evaluator, book);
+    }
+
+    // The rollouts the GUI plays, greedy and truncated with an evaluator
+    SolverOptions solverOptions = monteCarloOptions(1, evaluator.get());
+    solverOptions.numberOfSimulationsPerMove = options.simulations;
+    solverOptions.seed = options.seed;
+    solverOptions.tableSizeInMegabytes = options.tableSizeInMegabytes;
+    solverOptions.metrics = metrics;
+    return std::make_unique<MonteCarloPolicy>(solverOptions, evaluator, book);
+}
+
+static int maxTile(Grid grid) {
+    int maxExponent = 0;
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; ++i) {
+        maxExponent = std::max(maxExponent, static_cast<int>((grid >> (i * 4)) & 0xF));
+    }
+    return maxExponent == 0 ? 0 : 1 << maxExponent;
+}
+
+// Spawns come from one stream and the search from another, both derived from
+// the game index so that a game replays the same whichever thread plays it
+static GameResult playGame(Policy& policy, const SelfPlayOptions& options, int index, TrajectoryWriter* writer) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t gameSeed = deriveSeed(options.seed, static_cast<uint64_t>(index));
+    Rng gen(deriveSeed(gameSeed, 0));
+    policy.newGame();
+    policy.reseed(deriveSeed(gameSeed, 1));
+    uint64_t rolloutsBefore = policy.rolloutsPlayed();
+
+    GameTrajectory trajectory(static_cast<uint64_t>(index));
+    std::array<double, NUMBER_OF_MOVES> values;
+
+    Board board = newBoard(gen);
+    int moves = 0;
+    while (!isGameOver(board.grid)) {
+        Move bestMove = options.budgetMicroseconds > 0
+            ? policy.bestMove(board, std::chrono::microseconds(options.budgetMicroseconds))
+            : policy.bestMove(board);
+
+        Grid before = board.grid;
+        if (!playMove(board, bestMove, gen)) {
+            for (int i = 0; i < NUMBER_OF_MOVES; ++i) {
+                if (playMove(board, static_cast<Move>(i), gen)) {
+                    bestMove = static_cast<Move>(i);
+                    break;
+                }
+            }
+        }
+        ++moves;
+
+        if (writer != nullptr) {
+            if (policy.lastValues(values)) {
+                trajectory.append(before, bestMove, board.grid, values);
+            } else {
+                trajectory.append(before, bestMove, board.grid);
+            }
+        }
+    }
+
+    if (writer != nullptr) {
+        writer->write(trajectory);
+    }
+
+    GameResult result;
+    result.index = index;
+    result.seed = gameSeed;
+    result.grid = board.grid;
+    result.score = board.score;
+    result.maxTile = maxTile(board.grid);
+    result.moves = moves;
+    result.rollouts = policy.rolloutsPlayed() - rolloutsBefore;
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static void writeHeader(std::ostream& out, OutputFormat format) {
+    if (format == OutputFormat::CSV) {
+        out << "game,seed,grid,score,max_tile,moves,rollouts,wall_ms\n";
+    }
+}
+
+static void writeResult(std::ostream& out, OutputFormat format, const GameResult& result) {
+    char grid[17];
+    std::snprintf(grid, sizeof(grid), "%016llx", static_cast<unsigned long long>(result.grid));
+
+    if (format == OutputFormat::CSV) {
+        out << result.index << ',' << result.seed << ',' << grid << ',' << result.score << ','
+            << result.maxTile << ',' << result.moves << ',' << result.rollouts << ',' << result.milliseconds << '\n';
+    } else {
+        out << "{\"game\":" << result.index << ",\"seed\":" << result.seed << ",\"grid\":\"" << grid
+            << "\",\"score\":" << result.score << ",\"max_tile\":" << result.maxTile << ",\"moves\":" << result.moves
+            << ",\"rollouts\":" << result.rollouts << ",\"wall_ms\":" << result.milliseconds << "}\n";
+    }
+    // Results are streamed, a long run can be followed while it is going
+    out.flush();
+}
+
+int main(int argc, char* argv[]) {
+    SelfPlayOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream file;
+    if (options.output != "-") {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Cannot open " << options.output << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = options.output == "-" ? std::cout : file;
+    writeHeader(out, options.format);
+
+    // The evaluator is built once and shared by every game thread
+    std::shared_ptr<const Evaluator> evaluator;
+    if (!options.evaluator.empty()) {
+        try {
+            evaluator = makeEvaluator(options.evaluator);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::shared_ptr<const OpeningBook> book;
+    if (!options.book.empty()) {
+        try {
+            book = OpeningBook::load(options.book);
+        } catch (const std::exception& error) {
+            std::cerr << error.what() << "\n";
+            return 1;
+        }
+    }
+
+    std::unique_ptr<TrajectoryWriter> writer;
+    if (!options.trajectories.empty()) {
+        try {
+            writer = std::make_unique<TrajectoryWriter>(options.trajectories, true);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << "\n";
+            return 1;
+        }
+    }
+
+    // One sink for every game thread, the solvers record to it concurrently
+    Metrics metrics;
+
+    std::atomic<int> nextGame(0);
+    std::mutex outputMutex;
+    std::vector<GameResult> results;
+    results.reserve(options.games);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    int numberOfThreads = std::min(options.threads, std::max(1, options.games));
+    for (int t = 0; t < numberOfThreads; ++t) {
+        threads.emplace_back([&] {
+            std::unique_ptr<Policy> policy = makeSelfPlayPolicy(options, evaluator, book, &metrics);
+            for (int index = nextGame++; index < options.games; index = nextGame++) {
+                GameResult result = playGame(*policy, options, index, writer.get());
+
+                std::lock_guard<std::mutex> lock(outputMutex);
+                writeResult(out, options.format, result);
+                results.push_back(result);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (writer) {
+        writer->close();
+    }
+    if (!options.metrics.empty()) {
+        try {
+            metrics.dump(options.metrics, metricsFormatForPath(options.metrics));
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << "\n";
+            return 1;
+        }
+    }
+
+    long long totalScore = 0;
+    long long totalMoves = 0;
+    unsigned long long totalRollouts = 0;
+    int reached2048Count = 0;
+    for (const GameResult& result : results) {
+        totalScore += result.score;
+        totalMoves += result.moves;
+        totalRollouts += result.rollouts;
+        reached2048Count += result.maxTile >= 2048 ? 1 : 0;
+    }
+
+    int games = static_cast<int>(results.size());
+    std::fprintf(stderr, "%d games on %d threads in %.2f s\n", games, numberOfThreads, seconds);
+    std::fprintf(stderr, "mean score %.1f, 2048 reached in %d/%d games\n",
+        games > 0 ? static_cast<double>(totalScore) / games : 0.0, reached2048Count, games);
+    std::fprintf(stderr, "%.2f games/s, %.1f moves/s, %.0f rollouts/s\n",
+        games / seconds, totalMoves / seconds, totalRollouts / seconds);
+    return 0;
+}
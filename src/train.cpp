@@ -0,0 +1,200 @@
+// Temporal difference trainer of the n-tuple network
+// Author: Fabrice Renard
+// Date : 18 / 10 / 2026
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Board.hpp"
+#include "NTupleNetwork.hpp"
+#include "Random.hpp"
+
+struct TrainOptions {
+    int games = 100000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    uint64_t seed = 2048;
+    // Step size of the value, each weight moves by learningRate / features
+    double learningRate = 0.1;
+    int reportEvery = 1000;
+    std::string input;
+    std::string output = "ntuple.bin";
+};
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --games N          number of training games (100000)\n"
+              << "  --threads N        games played in parallel on shared weights (hardware threads)\n"
+              << "  --seed N           base seed (2048)\n"
+              << "  --alpha X          learning rate (0.1)\n"
+              << "  --report N         print statistics every N games (1000)\n"
+              << "  --input PATH       weights to resume from\n"
+              << "  --output PATH      weights written at the end (ntuple.bin)\n";
+}
+
+static bool parseOptions(int argc, char* argv[], TrainOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h" || i + 1 == argc) {
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (flag == "--games") {
+            options.games = std::atoi(value.c_str());
+        } else if (flag == "--threads") {
+            options.threads = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--seed") {
+            options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (flag == "--alpha") {
+            options.learningRate = std::atof(value.c_str());
+        } else if (flag == "--report") {
+            options.reportEvery = std::max(1, std::atoi(value.c_str()));
+        } else if (flag == "--input") {
+            options.input = value;
+        } else if (flag == "--output") {
+            options.output = value;
+        } else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+struct Episode {
+    int score;
+    Grid grid;
+};
+
+// Greedy play on the afterstate values, after each move the value of the
+// previous afterstate is moved towards the reward plus the value of the new
+// one, and the last afterstate towards 0
+static Episode playEpisode(NTupleNetwork& network, float stepSize, Rng& gen) {
+    Board board = newBoard(gen);
+    Grid previousAfterstate = 0;
+    bool hasPrevious = false;
+
+    for (;;) {
+        double bestValue = -std::numeric_limits<double>::infinity();
+        double bestAfterstateValue = 0.0;
+        uint32_t bestReward = 0;
+        Grid bestAfterstate = 0;
+
+        for (int i = 0; i < NUMBER_OF_MOVES; ++i) {
+            uint32_t reward = 0;
+            Grid afterstate = moveGrid(board.grid, static_cast<Move>(i), reward);
+            if (afterstate == board.grid) {
+                continue;
+            }
+
+            double afterstateValue = network.evaluate(afterstate);
+            if (reward + afterstateValue > bestValue) {
+                bestValue = reward + afterstateValue;
+                bestAfterstateValue = afterstateValue;
+                bestReward = reward;
+                bestAfterstate = afterstate;
+            }
+        }
+
+        if (bestValue == -std::numeric_limits<double>::infinity()) {
+            break;
+        }
+
+        if (hasPrevious) {
+            double error = bestReward + bestAfterstateValue - network.evaluate(previousAfterstate);
+            network.update(previousAfterstate, static_cast<float>(stepSize * error));
+        }
+
+        board.grid = bestAfterstate;
+        board.score += static_cast<int>(bestReward);
+        addRandomTile(board, gen);
+        previousAfterstate = bestAfterstate;
+        hasPrevious = true;
+    }
+
+    if (hasPrevious) {
+        network.update(previousAfterstate, static_cast<float>(-stepSize * network.evaluate(previousAfterstate)));
+    }
+
+    return Episode{ board.score, board.grid };
+}
+
+static int maxExponent(Grid grid) {
+    int exponent = 0;
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; ++i) {
+        exponent = std::max(exponent, static_cast<int>((grid >> (i * 4)) & 0xF));
+    }
+    return exponent;
+}
+
+int main(int argc, char* argv[]) {
+    TrainOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<NTupleNetwork> network;
+    try {
+        network = options.input.empty() ? std::make_unique<NTupleNetwork>() : NTupleNetwork::load(options.input);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    float stepSize = static_cast<float>(options.learningRate / network->numberOfFeatures());
+
+    std::atomic<int> nextGame(0);
+    std::mutex reportMutex;
+    long long windowScore = 0;
+    int windowGames = 0;
+    int window2048 = 0;
+    int gamesDone = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // Hogwild: every thread updates the shared weights without locking
+    std::vector<std::thread> threads;
+    for (int t = 0; t < options.threads; ++t) {
+        threads.emplace_back([&, t] {
+            Rng gen(deriveSeed(options.seed, static_cast<uint64_t>(t)));
+            while (nextGame++ < options.games) {
+                Episode episode = playEpisode(*network, stepSize, gen);
+
+                std::lock_guard<std::mutex> lock(reportMutex);
+                windowScore += episode.score;
+                window2048 += maxExponent(episode.grid) >= 11 ? 1 : 0;
+                ++windowGames;
+                if (++gamesDone % options.reportEvery == 0) {
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                    std::fprintf(stderr, "%d games, mean score %.1f, 2048 rate %.3f, %.1f games/s\n", gamesDone,
+                        static_cast<double>(windowScore) / windowGames, static_cast<double>(window2048) / windowGames,
+                        gamesDone / seconds);
+                    windowScore = 0;
+                    window2048 = 0;
+                    windowGames = 0;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    try {
+        network->save(options.output);
+    } catch (const std::exception& error) {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    std::cerr << "weights saved to " << options.output << "\n";
+    return 0;
+}
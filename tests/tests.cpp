@@ -1,5 +1,22 @@
 #include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "Arena.hpp"
+#include "AsyncSolver.hpp"
+#include "BatchRollout.hpp"
 #include "Game.hpp"
+#include "HeuristicEvaluator.hpp"
+#include "Mcts.hpp"
+#include "Metrics.hpp"
+#include "NTupleNetwork.hpp"
+#include "OpeningBook.hpp"
+#include "Policy.hpp"
+#include "Solver.hpp"
+#include "Symmetry.hpp"
+#include "ThreadPool.hpp"
+#include "TrajectoryLog.hpp"
 
 class GameTest : public ::testing::Test {
 protected:
@@ -8,4 +25,690 @@ protected:
     }
 
     std::unique_ptr<Game> game;
-};
\ No newline at end of file
+};
+
+TEST_F(GameTest, MoveLeftMergesAndScores) {
+    // Row 0: 2 2 4 0
+    game->setGrid(0x0211ULL);
+    ASSERT_TRUE(game->moveLeft());
+
+    Grid grid = game->getGrid();
+    EXPECT_EQ(grid & 0xFFULL, 0x22ULL);
+    EXPECT_EQ(game->getScore(), 4);
+}
+
+TEST_F(GameTest, MovesMatchAcrossOrientations) {
+    uint32_t score = 0;
+    // Column 0: 2 2 0 0 from top to bottom
+    Grid grid = 0x0000000000010001ULL;
+
+    EXPECT_EQ(transposeGrid(transposeGrid(grid)), grid);
+    EXPECT_EQ(transposeGrid(moveRowsLeft(transposeGrid(grid), score)), 0x2ULL);
+    EXPECT_EQ(transposeGrid(moveRowsRight(transposeGrid(grid), score)), 0x0002000000000000ULL);
+    EXPECT_EQ(score, 8u);
+}
+
+TEST_F(GameTest, InvalidMoveLeavesGridUnchanged) {
+    // Row 0: 2 4 0 0
+    game->setGrid(0x21ULL);
+    EXPECT_FALSE(game->moveLeft());
+    EXPECT_EQ(game->getGrid(), 0x21ULL);
+}
+
+TEST_F(GameTest, GameOverOnLockedGrid) {
+    game->setGrid(0x1212212112122121ULL);
+    EXPECT_TRUE(game->isGameOver());
+
+    game->setGrid(0x1212212112122111ULL);
+    EXPECT_FALSE(game->isGameOver());
+}
+
+TEST_F(GameTest, SeededGamesAreReproducible) {
+    Game first(42);
+    Game second(42);
+    EXPECT_TRUE(first == second);
+
+    for (int i = 0; i < 20; ++i) {
+        first.makeMove(static_cast<Move>(i % 4));
+        second.makeMove(static_cast<Move>(i % 4));
+    }
+    EXPECT_TRUE(first == second);
+}
+
+TEST_F(GameTest, SpawnFillsOnlyEmptyCell) {
+    Rng gen(7);
+    for (int cell = 0; cell < GRID_SIZE * GRID_SIZE; ++cell) {
+        Board board;
+        board.grid = 0x5555555555555555ULL & ~(0xFULL << (cell * 4));
+        ASSERT_EQ(countEmptyCells(board.grid), 1);
+        ASSERT_TRUE(addRandomTile(board, gen));
+
+        Grid tile = (board.grid >> (cell * 4)) & 0xF;
+        EXPECT_TRUE(tile == 1 || tile == 2);
+        EXPECT_FALSE(addRandomTile(board, gen));
+    }
+}
+
+TEST_F(GameTest, LegalMovesMatchSlides) {
+    Rng gen(16);
+    for (int i = 0; i < 100000; ++i) {
+        // Few distinct exponents so that full and blocked boards are common
+        Grid grid = 0;
+        for (int cell = 0; cell < GRID_SIZE * GRID_SIZE; ++cell) {
+            grid |= static_cast<Grid>(randomBelow(gen, i % 2 == 0 ? 4 : 16)) << (cell * 4);
+        }
+
+        int expected = 0;
+        for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+            uint32_t score = 0;
+            if (moveGrid(grid, static_cast<Move>(m), score) != grid) {
+                expected |= 1 << m;
+            }
+        }
+        ASSERT_EQ(legalMoves(grid), expected) << grid;
+        ASSERT_EQ(isGameOver(grid), expected == 0);
+    }
+    // Row 0: 2 4 2 4, only DOWN is legal
+    EXPECT_EQ(legalMoves(0x0000000000002121ULL), 1 << static_cast<int>(Move::DOWN));
+}
+
+TEST_F(GameTest, CanonicalGridMapsMovesBack) {
+    Rng gen(17);
+    for (int i = 0; i < 10000; ++i) {
+        Grid grid = gen();
+        CanonicalGrid canonical = canonicalGrid(grid);
+        ASSERT_EQ(applySymmetry(grid, canonical.symmetry), canonical.key);
+
+        for (int s = 0; s < NUMBER_OF_SYMMETRIES; ++s) {
+            Grid symmetric = applySymmetry(grid, s);
+            ASSERT_EQ(applySymmetry(symmetric, inverseSymmetry(s)), grid);
+            ASSERT_EQ(canonicalKey(symmetric), canonical.key);
+
+            for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+                uint32_t score = 0;
+                uint32_t symmetricScore = 0;
+                Grid moved = moveGrid(grid, static_cast<Move>(m), score);
+                Move mapped = symmetricMove(static_cast<Move>(m), s);
+                ASSERT_EQ(applySymmetry(moved, s), moveGrid(symmetric, mapped, symmetricScore));
+                ASSERT_EQ(score, symmetricScore);
+                ASSERT_EQ(symmetricMove(mapped, inverseSymmetry(s)), static_cast<Move>(m));
+            }
+        }
+    }
+}
+
+TEST_F(GameTest, ExpectimaxOnlyPicksLegalMoves) {
+    ExpectimaxPolicy policy;
+    Board board;
+    // Row 0: 2 4 2 4, the rest empty, so only DOWN changes the grid
+    board.grid = 0x2121ULL;
+
+    EXPECT_EQ(policy.bestMove(board), Move::DOWN);
+}
+
+TEST_F(GameTest, TranspositionTableReplacement) {
+    TranspositionTable depthPreferred(1, Replacement::DEPTH_PREFERRED);
+    TableEntry entry;
+
+    EXPECT_FALSE(depthPreferred.probe(0x1234ULL, entry));
+    depthPreferred.store(0x1234ULL, 10.0f, 3);
+    depthPreferred.store(0x1234ULL, 20.0f, 1);
+    ASSERT_TRUE(depthPreferred.probe(0x1234ULL, entry));
+    EXPECT_EQ(entry.value, 10.0f);
+    EXPECT_EQ(entry.depth, 3);
+    EXPECT_EQ(depthPreferred.hits(), 1u);
+    EXPECT_EQ(depthPreferred.misses(), 1u);
+
+    TranspositionTable alwaysReplace(1, Replacement::ALWAYS_REPLACE);
+    alwaysReplace.store(0x1234ULL, 10.0f, 3);
+    alwaysReplace.store(0x1234ULL, 20.0f, 1);
+    ASSERT_TRUE(alwaysReplace.probe(0x1234ULL, entry));
+    EXPECT_EQ(entry.value, 20.0f);
+    EXPECT_EQ(entry.depth, 1);
+    EXPECT_EQ(entry.spread, 0.0f);
+
+    // The spread is rounded up, never down
+    alwaysReplace.store(0x5678ULL, -3.5f, 40, 1234.5f);
+    ASSERT_TRUE(alwaysReplace.probe(0x5678ULL, entry));
+    EXPECT_EQ(entry.value, -3.5f);
+    EXPECT_EQ(entry.depth, 40);
+    EXPECT_GE(entry.spread, 1234.5f);
+    EXPECT_LT(entry.spread, 1234.5f * 1.01f);
+}
+
+TEST_F(GameTest, ThreadPoolForkJoin) {
+    ThreadPool pool(4);
+    std::vector<int> visits(1000, 0);
+    pool.parallelFor(0, 1000, 8, [&](int i) { visits[i]++; });
+    EXPECT_EQ(std::count(visits.begin(), visits.end(), 1), 1000);
+
+    // Nested forks from inside the workers must not deadlock
+    std::atomic<int> leaves(0);
+    pool.parallelFor(0, 16, 1, [&](int) {
+        pool.parallelFor(0, 16, 1, [&](int) { leaves++; });
+    });
+    EXPECT_EQ(leaves.load(), 256);
+
+    EXPECT_EQ(pool.enqueue([](int x) { return x * 2; }, 21).get(), 42);
+
+    // Jobs always run on a worker, the caller is not one
+    EXPECT_EQ(pool.currentWorker(), -1);
+    std::atomic<int> outside(0);
+    pool.parallelFor(0, 64, 1, [&](int) {
+        int worker = pool.currentWorker();
+        outside += worker < 0 || worker >= 4 ? 1 : 0;
+    });
+    EXPECT_EQ(outside.load(), 0);
+}
+
+TEST_F(GameTest, SolverPrunesIllegalMoves) {
+    SolverOptions options;
+    options.numberOfSimulationsPerMove = 20;
+    options.numThreads = 2;
+    options.seed = 1;
+    options.tableSizeInMegabytes = 0;
+    Solver solver(options);
+
+    Board board;
+    // Row 0: 2 4 2 4, only DOWN is legal
+    board.grid = 0x2121ULL;
+    SearchResult result = solver.search(board);
+
+    EXPECT_EQ(result.move, Move::DOWN);
+    EXPECT_EQ(result.rollouts[static_cast<int>(Move::LEFT)], 0);
+    EXPECT_EQ(result.rollouts[static_cast<int>(Move::UP)], 0);
+
+    // Rollouts are not lost to integer division over the threads. Three
+    // moves are legal, so the two rounds spend 10 rollouts on each move and
+    // then 15 on each of the two best, odd shares split over two threads
+    board.grid = 0x0000000000120001ULL;
+    options.dominanceThreshold = std::numeric_limits<double>::infinity();
+    Solver halving(options);
+    result = halving.search(board);
+    std::vector<int> rollouts(result.rollouts.begin(), result.rollouts.end());
+    std::sort(rollouts.begin(), rollouts.end());
+    EXPECT_EQ(rollouts, std::vector<int>({ 0, 10, 25, 25 }));
+    EXPECT_EQ(result.rounds, 2);
+}
+
+TEST_F(GameTest, AnytimeSearchReturnsLegalMove) {
+    SolverOptions options;
+    options.numThreads = 2;
+    options.seed = 3;
+    options.tableSizeInMegabytes = 0;
+    Solver solver(options);
+
+    Board board;
+    board.grid = 0x2121ULL;
+    SearchResult result = solver.search(board, std::chrono::microseconds(2000));
+    EXPECT_EQ(result.move, Move::DOWN);
+
+    board.grid = 0x0000000000120001ULL;
+    result = solver.search(board, std::chrono::microseconds(2000));
+    EXPECT_GT(result.rounds, 0);
+    EXPECT_NE(result.values[static_cast<int>(result.move)], -std::numeric_limits<double>::infinity());
+}
+
+TEST_F(GameTest, BatchedRolloutsMatchScalarMean) {
+    Board board;
+    board.grid = 0x0000000000120001ULL;
+    Rng gen(11);
+    RolloutStats scalar = runSimulations(board, Move::LEFT, 4000, gen);
+    double scalarMean = scalar.total / scalar.count;
+
+    for (BatchIsa isa : { BatchIsa::PORTABLE, BatchIsa::AVX2, BatchIsa::AVX512 }) {
+        if (!batchIsaSupported(isa)) {
+            continue;
+        }
+        RolloutStats batched = runSimulationsBatched(board, Move::LEFT, 4000, gen, isa);
+        EXPECT_EQ(batched.count, 4000);
+        EXPECT_NEAR(batched.total / batched.count, scalarMean, 0.05 * scalarMean);
+    }
+}
+
+TEST_F(GameTest, SolverReseedIsReproducible) {
+    SolverOptions options;
+    options.numThreads = 2;
+    options.numberOfSimulationsPerMove = 64;
+    options.tableSizeInMegabytes = 0;
+    options.seed = 1;
+    Solver first(options);
+    options.seed = 2;
+    Solver second(options);
+
+    Board board;
+    board.grid = 0x0000000000120001ULL;
+    first.search(board);
+    first.reseed(9);
+    second.reseed(9);
+    SearchResult a = first.search(board);
+    SearchResult b = second.search(board);
+    EXPECT_EQ(a.values, b.values);
+    EXPECT_GT(first.rolloutsPlayed(), second.rolloutsPlayed());
+}
+
+TEST_F(GameTest, SolverMetricsCountSearches) {
+    SolverOptions options;
+    options.numThreads = 2;
+    options.numberOfSimulationsPerMove = 32;
+    options.tableSizeInMegabytes = 1;
+    Solver solver(options);
+
+    // The second search finds the first one's rollouts in the table
+    Board board;
+    board.grid = 0x0000000000120001ULL;
+    solver.search(board);
+    solver.search(board);
+
+    MetricsSnapshot snapshot = solver.metrics().snapshot();
+    EXPECT_EQ(snapshot.total(Counter::DECISIONS), 2u);
+    EXPECT_EQ(snapshot.decisionLatency.count, 2u);
+    EXPECT_LE(snapshot.decisionLatency.p50, snapshot.decisionLatency.max);
+    EXPECT_EQ(snapshot.total(Counter::ROLLOUTS), solver.rolloutsPlayed());
+    EXPECT_GT(snapshot.total(Counter::MOVES), snapshot.total(Counter::ROLLOUTS));
+    EXPECT_GT(snapshot.total(Counter::TABLE_HITS), 0u);
+    EXPECT_GT(snapshot.total(Counter::JOBS), 0u);
+    // Every round is submitted to the pool from outside it
+    EXPECT_GE(snapshot.queueWait.count, 2u);
+    EXPECT_NE(snapshot.toJson().find("\"decision_latency_seconds\""), std::string::npos);
+    EXPECT_NE(snapshot.toPrometheus().find("solver_rollouts_total{thread=\"0\"}"), std::string::npos);
+
+    solver.metrics().reset();
+    EXPECT_EQ(solver.metrics().snapshot().total(Counter::ROLLOUTS), 0u);
+
+    // Percentiles are bucket upper bounds, within 12.5% of the true value
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.record(std::chrono::microseconds(i));
+    }
+    EXPECT_NEAR(histogram.percentile(0.5).count(), 500000.0, 500000.0 * 0.125);
+    EXPECT_NEAR(histogram.percentile(0.99).count(), 990000.0, 990000.0 * 0.125);
+    EXPECT_EQ(histogram.percentile(1.0), std::chrono::microseconds(1000));
+}
+
+TEST_F(GameTest, SearchBatchIsIndependentOfThreads) {
+    std::vector<Grid> grids;
+    Rng gen(5);
+    Board board = newBoard(gen);
+    for (int i = 0; i < 12 && !isGameOver(board.grid); ++i) {
+        grids.push_back(board.grid);
+        int legal = legalMoves(board.grid);
+        playMove(board, static_cast<Move>(__builtin_ctz(legal)), gen);
+    }
+
+    // Both solvers keep a table, which batches leave alone
+    SolverOptions options;
+    options.numberOfSimulationsPerMove = 16;
+    options.seed = 3;
+    options.numThreads = 1;
+    Solver single(options);
+    options.numThreads = 3;
+    Solver pooled(options);
+
+    std::vector<SearchResult> a = single.searchBatch(grids);
+    std::vector<SearchResult> b = pooled.searchBatch(grids);
+    ASSERT_EQ(a.size(), grids.size());
+    for (size_t i = 0; i < grids.size(); ++i) {
+        EXPECT_EQ(a[i].move, b[i].move);
+        EXPECT_EQ(a[i].values, b[i].values);
+        EXPECT_TRUE(isMoveLegal(legalMoves(grids[i]), a[i].move));
+    }
+    EXPECT_EQ(single.rolloutsPlayed(), pooled.rolloutsPlayed());
+
+    // A second batch over the same boards does not read the first one's
+    std::vector<SearchResult> c = single.searchBatch(grids);
+    std::vector<SearchResult> d = pooled.searchBatch(grids);
+    for (size_t i = 0; i < grids.size(); ++i) {
+        EXPECT_EQ(c[i].values, d[i].values);
+    }
+    EXPECT_EQ(pooled.table()->hits() + pooled.table()->misses(), 0u);
+
+    // Fewer boards than threads take the same path
+    std::vector<Grid> pair(grids.begin(), grids.begin() + 2);
+    single.reseed(options.seed);
+    pooled.reseed(options.seed);
+    std::vector<SearchResult> e = single.searchBatch(pair);
+    std::vector<SearchResult> f = pooled.searchBatch(pair);
+    ASSERT_EQ(f.size(), 2u);
+    for (size_t i = 0; i < pair.size(); ++i) {
+        EXPECT_EQ(e[i].move, f[i].move);
+        EXPECT_EQ(e[i].values, f[i].values);
+        // The same board at the same index of a first batch, as above
+        EXPECT_EQ(e[i].values, a[i].values);
+    }
+    EXPECT_EQ(pooled.table()->hits() + pooled.table()->misses(), 0u);
+}
+
+TEST_F(GameTest, AsyncSolverAnswersCancelsAndPonders) {
+    Metrics metrics;
+    SolverOptions options;
+    options.numThreads = 1;
+    options.numberOfSimulationsPerMove = 16;
+    options.seed = 11;
+    options.metrics = &metrics;
+    auto policy = std::make_shared<MonteCarloPolicy>(options);
+    AsyncSolver solver(policy, true, std::chrono::microseconds(200));
+
+    Board board;
+    board.grid = 0x0000000000120001ULL;
+    Decision decision = solver.request(board).get();
+    EXPECT_TRUE(decision.searched);
+    EXPECT_FALSE(decision.cancelled);
+    EXPECT_EQ(decision.board.grid, board.grid);
+    EXPECT_TRUE(isMoveLegal(legalMoves(board.grid), decision.move));
+    EXPECT_TRUE(decision.hasValues);
+
+    // Once the callback runs it holds the solver's thread, so the requests
+    // below queue up behind it
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<Decision> delivered;
+    solver.request(board, std::chrono::microseconds(1000), [&](const Decision& answer) {
+        delivered.set_value(answer);
+        released.wait();
+    });
+    EXPECT_TRUE(delivered.get_future().get().searched);
+    std::future<Decision> replaced = solver.request(board);
+    std::future<Decision> stale = solver.request(board);
+    EXPECT_TRUE(replaced.get().cancelled);
+    solver.cancel();
+    release.set_value();
+    EXPECT_TRUE(stale.get().cancelled);
+    EXPECT_FALSE(solver.request(board).get().cancelled);
+
+    for (int i = 0; i < 1000 && solver.positionsPondered() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_GT(solver.positionsPondered(), 0u);
+
+    // The three requests searched are the only decisions, pondering adds none
+    EXPECT_EQ(metrics.snapshot().total(Counter::DECISIONS), 3u);
+    EXPECT_EQ(metrics.snapshot().decisionLatency.count, 3u);
+}
+
+TEST_F(GameTest, TrajectoryLogRoundTrip) {
+    std::string path = ::testing::TempDir() + "trajectory_log_test.bin";
+    Rng gen(5);
+    std::vector<Grid> played;
+    {
+        TrajectoryWriter writer(path, true);
+        for (uint64_t gameId = 0; gameId < 3; ++gameId) {
+            GameTrajectory trajectory(gameId);
+            Board board = newBoard(gen);
+            for (int ply = 0; ply < 20 && !isGameOver(board.grid); ++ply) {
+                Grid before = board.grid;
+                Move move = static_cast<Move>(ply % NUMBER_OF_MOVES);
+                playMove(board, move, gen);
+                trajectory.append(before, move, board.grid, { 1.0, 2.0, 3.0, static_cast<double>(ply) });
+                played.push_back(before);
+            }
+            writer.write(trajectory);
+        }
+
+        // A forced move plays no rollout but still has values to log
+        SolverOptions options;
+        options.numThreads = 1;
+        options.tableSizeInMegabytes = 0;
+        MonteCarloPolicy policy(options);
+        Board board;
+        // Row 0: 2 4 2 4, only DOWN is legal
+        board.grid = 0x2121ULL;
+        Move move = policy.bestMove(board);
+        std::array<double, NUMBER_OF_MOVES> values;
+        ASSERT_TRUE(policy.lastValues(values));
+        GameTrajectory trajectory(3);
+        playMove(board, move, gen);
+        trajectory.append(0x2121ULL, move, board.grid, values);
+        played.push_back(0x2121ULL);
+        writer.write(trajectory);
+    }
+
+    TrajectoryReader reader(path);
+    ASSERT_EQ(reader.numberOfGames(), 4u);
+    ASSERT_EQ(reader.numberOfPlies(), played.size());
+    EXPECT_TRUE(reader.hasScores());
+
+    size_t index = 0;
+    for (size_t g = 0; g < reader.numberOfGames(); ++g) {
+        GameView game = reader.game(g);
+        EXPECT_EQ(game.gameId(), g);
+        for (size_t i = 0; i < game.size(); ++i, ++index) {
+            Ply ply = game[i];
+            EXPECT_EQ(ply.grid, played[index]);
+            if (g == 3) {
+                EXPECT_EQ(ply.move(), Move::DOWN);
+                for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+                    EXPECT_EQ(std::isfinite(ply.scores[m]), m == static_cast<int>(Move::DOWN));
+                }
+                continue;
+            }
+            EXPECT_EQ(ply.scores[3], static_cast<float>(i));
+
+            // Replaying the move and the logged spawn gives the next grid
+            Board board;
+            board.grid = ply.grid;
+            if (applyMove(board, ply.move()) && ply.spawned()) {
+                board.grid |= static_cast<Grid>(ply.spawnTile()) << (ply.spawnCell() * 4);
+            }
+            if (i + 1 < game.size()) {
+                EXPECT_EQ(board.grid, game[i + 1].grid);
+            }
+        }
+    }
+
+    // An index entry pointing near the top of the address space must not
+    // wrap around the bounds check
+    std::string corruptPath = ::testing::TempDir() + "trajectory_log_corrupt.bin";
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        uint64_t indexOffset;
+        std::memcpy(&indexOffset, bytes.data() + bytes.size() - 24, sizeof(indexOffset));
+        uint64_t offset = ~uint64_t(7);
+        std::memcpy(&bytes[indexOffset], &offset, sizeof(offset));
+        std::ofstream out(corruptPath, std::ios::binary);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    EXPECT_THROW(TrajectoryReader corrupt(corruptPath), std::runtime_error);
+    std::remove(corruptPath.c_str());
+    std::remove(path.c_str());
+}
+
+TEST_F(GameTest, ArenaBumpsResetsAndTracksHighWater) {
+    Arena arena(1024, 4096);
+    unsigned char* first = static_cast<unsigned char*>(arena.allocate(1));
+    Grid* grid = arena.make<Grid>(Grid(42));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(grid, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(grid) % alignof(Grid), 0u);
+    EXPECT_EQ(*grid, 42u);
+
+    // Larger than a chunk, served from a chunk of its own
+    EXPECT_NE(arena.makeArray<uint32_t>(512), nullptr);
+    EXPECT_GE(arena.bytesUsed(), 1 + sizeof(Grid) + 512 * sizeof(uint32_t));
+    EXPECT_EQ(arena.allocate(4096), nullptr);
+    size_t used = arena.bytesUsed();
+
+    arena.reset();
+    EXPECT_EQ(arena.bytesUsed(), 0u);
+    EXPECT_EQ(arena.highWaterMark(), used);
+    EXPECT_EQ(arena.allocate(1), first);
+    size_t reserved = arena.bytesReserved();
+    for (int i = 0; i < 100; ++i) {
+        arena.reset();
+        ASSERT_NE(arena.makeArray<Grid>(64), nullptr);
+    }
+    EXPECT_EQ(arena.bytesReserved(), reserved);
+}
+
+TEST_F(GameTest, MctsReusesSubtreeAfterMoveAndSpawn) {
+    for (MctsParallelism parallelism : { MctsParallelism::TREE, MctsParallelism::ROOT }) {
+        MctsOptions options;
+        options.numThreads = 2;
+        options.iterations = 400;
+        options.seed = 19;
+        options.parallelism = parallelism;
+        Mcts mcts(options);
+
+        Rng gen(19);
+        Board board = newBoard(gen);
+        MctsResult result = mcts.search(board);
+        EXPECT_EQ(result.playouts, options.iterations);
+        EXPECT_EQ(result.reusedVisits, 0);
+        EXPECT_TRUE(isMoveLegal(legalMoves(board.grid), result.move));
+
+        // Every playout but those expanding a root lands below a root move,
+        // and no virtual loss is left behind
+        int visits = 0;
+        for (int count : result.visits) {
+            visits += count;
+        }
+        EXPECT_LE(visits, result.playouts);
+        EXPECT_GE(visits, result.playouts - options.numThreads);
+
+        playMove(board, result.move, gen);
+        result = mcts.search(board);
+        EXPECT_GT(result.reusedVisits, 0);
+        EXPECT_TRUE(isMoveLegal(legalMoves(board.grid), result.move));
+        EXPECT_GT(mcts.bytesUsed(), 0u);
+        EXPECT_LE(mcts.bytesUsed(), mcts.highWaterMark());
+
+        mcts.newGame();
+        EXPECT_EQ(mcts.bytesUsed(), 0u);
+    }
+}
+
+// Arenas of three nodes fill up while subtrees are copied and cannot hold the
+// moves of a root, every root must still be searched over all of its moves
+TEST_F(GameTest, MctsReuseKeepsEveryRootMoveWhenArenasFill) {
+    MctsOptions options;
+    options.numThreads = 4;
+    options.iterations = 1000;
+    options.seed = 23;
+    options.parallelism = MctsParallelism::TREE;
+    options.maxNodes = 12;
+    Mcts mcts(options);
+
+    Rng gen(23);
+    Board board = newBoard(gen);
+    int reused = 0;
+    for (int ply = 0; ply < 40 && !isGameOver(board.grid); ++ply) {
+        MctsResult result = mcts.search(board);
+        int legal = legalMoves(board.grid);
+        for (int m = 0; m < NUMBER_OF_MOVES; ++m) {
+            EXPECT_EQ(result.visits[m] > 0, isMoveLegal(legal, static_cast<Move>(m))) << "ply " << ply << ", move " << m;
+        }
+        reused += result.reusedVisits > 0 ? 1 : 0;
+        playMove(board, result.move, gen);
+    }
+    EXPECT_GT(reused, 0);
+}
+
+TEST_F(GameTest, OpeningBookAnswersSymmetricPositions) {
+    std::string path = ::testing::TempDir() + "opening_book_test.bin";
+    // Row 0: 2 4 2 4 with a 2 below its first tile, only UP and DOWN are legal
+    Grid grid = 0x0000000000012121ULL;
+    Grid other = 0x0000000000000011ULL;
+    OpeningBook::write(path, { { grid, 10.0f, static_cast<uint32_t>(Move::DOWN) },
+        { other, 1.0f, static_cast<uint32_t>(Move::LEFT) }, { other, 4.0f, static_cast<uint32_t>(Move::RIGHT) } });
+    std::unique_ptr<OpeningBook> book = OpeningBook::load(path);
+    EXPECT_EQ(book->size(), 2u);
+
+    for (int s = 0; s < NUMBER_OF_SYMMETRIES; ++s) {
+        Move move;
+        float value;
+        ASSERT_TRUE(book->probe(applySymmetry(grid, s), move, value));
+        EXPECT_EQ(move, symmetricMove(Move::DOWN, s));
+        EXPECT_EQ(value, 10.0f);
+    }
+    Move move;
+    float value;
+    ASSERT_TRUE(book->probe(other, move, value));
+    EXPECT_EQ(move, Move::RIGHT);
+    EXPECT_FALSE(book->probe(0x0000000000000021ULL, move, value));
+
+    SolverOptions options;
+    options.numThreads = 1;
+    options.book = book.get();
+    Solver solver(options);
+    Board board;
+    board.grid = flipGrid(grid);
+    board.score = 100;
+    SearchResult result = solver.search(board);
+    EXPECT_TRUE(result.fromBook);
+    EXPECT_EQ(result.move, Move::UP);
+    EXPECT_EQ(result.values[static_cast<int>(Move::UP)], 110.0);
+    EXPECT_EQ(solver.rolloutsPlayed(), 0u);
+
+    book.reset();
+    std::remove(path.c_str());
+}
+
+TEST_F(GameTest, NTupleNetworkIsSymmetricAndReloads) {
+    NTupleNetwork network({ { 0, 1, 2, 3 }, { 0, 1, 4, 5 } });
+    Rng gen(13);
+    Board board = newBoard(gen);
+    for (int i = 0; i < 30; ++i) {
+        playMove(board, static_cast<Move>(randomBelow(gen, NUMBER_OF_MOVES)), gen);
+        network.update(board.grid, 0.5f);
+    }
+
+    double value = network.evaluate(board.grid);
+    EXPECT_NE(value, 0.0);
+    EXPECT_FLOAT_EQ(network.evaluate(transposeGrid(board.grid)), value);
+    EXPECT_FLOAT_EQ(network.evaluate(mirrorGrid(board.grid)), value);
+    EXPECT_FLOAT_EQ(network.evaluate(flipGrid(board.grid)), value);
+
+    std::string path = ::testing::TempDir() + "ntuple_network_test.bin";
+    network.save(path);
+    std::unique_ptr<NTupleNetwork> loaded = NTupleNetwork::load(path);
+    EXPECT_EQ(loaded->numberOfWeights(), network.numberOfWeights());
+    EXPECT_FLOAT_EQ(loaded->evaluate(board.grid), value);
+    std::remove(path.c_str());
+}
+
+TEST_F(GameTest, HeuristicEvaluatorLineTerms) {
+    HeuristicWeights weights;
+    weights.alive = 0.0;
+    weights.merges = 0.0;
+    weights.monotonicity = 0.0;
+    weights.sum = 0.0;
+    weights.emptyCells = 1.0;
+    HeuristicEvaluator evaluator(weights);
+
+    // Every empty cell is counted once by its row and once by its column
+    Grid grid = 0x0000000000120001ULL;
+    EXPECT_DOUBLE_EQ(evaluator.evaluate(grid), 2.0 * countEmptyCells(grid));
+
+    HeuristicEvaluator defaults;
+    EXPECT_FLOAT_EQ(defaults.evaluate(transposeGrid(grid)), defaults.evaluate(grid));
+    EXPECT_FLOAT_EQ(defaults.evaluate(mirrorGrid(grid)), defaults.evaluate(grid));
+
+    weights.corner = 1.0;
+    evaluator.setWeights(weights);
+    EXPECT_DOUBLE_EQ(evaluator.evaluate(0x2ULL), 2.0 * countEmptyCells(0x2ULL) + 2.0 * 2);
+}
+
+TEST_F(GameTest, RolloutPoliciesStopAtCutoff) {
+    Rng gen(17);
+    RolloutOptions options;
+    options.policy = RolloutPolicy::GREEDY;
+    options.depth = 1;
+
+    // The only scoring move merges the two 2s
+    Board board;
+    board.grid = 0x11ULL;
+    EXPECT_EQ(simulate(board, gen, options), 4.0);
+
+    HeuristicEvaluator heuristic;
+    options.evaluator = &heuristic;
+    EXPECT_GT(simulate(board, gen, options), 4.0);
+
+    // A lost position is scored as is, without the evaluator
+    board.grid = 0x1212212112122121ULL;
+    board.score = 100;
+    for (RolloutPolicy policy : { RolloutPolicy::UNIFORM, RolloutPolicy::LEGAL_RANDOM, RolloutPolicy::EPSILON_GREEDY }) {
+        options.policy = policy;
+        EXPECT_EQ(simulate(board, gen, options), 100.0);
+    }
+}